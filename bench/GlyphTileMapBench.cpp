@@ -0,0 +1,479 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       GlyphTileMapBench.cpp
+/// License:        MIT
+/// Description:    Headless microbenchmarks of GlyphTileMap, printed as CSV.
+///
+/// Usage:
+///
+///     glyphtilemap_bench [--font <path>] [--repeats <n>] [--filter <text>]
+///
+/// Every benchmark is run once to warm up and then <n> times (default 5);
+/// the best and median time per operation are reported. Inputs come from a
+/// fixed seed and every glyph is prewarmed, so runs are repeatable and
+/// rasterization is not measured. Draw benchmarks render into an offscreen
+/// sf::RenderTexture and are skipped when no OpenGL context is available.
+///
+/// Before any timing, the SIMD quad kernel is checked against the scalar one
+/// on random runs of every length up to a few batches. The benchmark exits
+/// with a failure if their vertices differ in any bit.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <SFML/System.hpp>
+#include <SFML/Graphics.hpp>
+#include <SFML/OpenGL.hpp>
+
+#include "GlyphTileAnimator.h"
+#include "GlyphTileMap.h"
+#include "QuadKernels.h"
+
+#ifndef GLYPH_TILE_MAP_BENCH_FONT
+#define GLYPH_TILE_MAP_BENCH_FONT "bench/fonts/DejaVuSansMono.ttf"
+#endif
+
+namespace
+{
+
+///////////////////////////////////////////////////////////////////////////////
+struct Options {
+    std::string font;
+    sf::Uint32 repeats;
+    std::string filter;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// Random inputs are drawn from a fixed seed so every run does the same work.
+///////////////////////////////////////////////////////////////////////////////
+class Inputs {
+public:
+
+    Inputs(const sf::Vector2u& area, sf::Uint32 count)
+        : m_random(1)
+    {
+        std::vector<sf::Uint32> charset = getCharset();
+
+        for (sf::Uint32 i = 0; i < count; ++i) {
+            coords.emplace_back(next(area.x), next(area.y));
+            tiles.emplace_back(
+                static_cast<wchar_t>(charset[next(charset.size())]),
+                static_cast<GlyphTileMap::Tile::Type>(next(4)),
+                color(), color());
+        }
+    }
+
+    static std::vector<sf::Uint32> getCharset()
+    {
+        return GlyphTileMap::getCharset({{0x20, 0x7E}, {0x2500, 0x257F}});
+    }
+
+    std::vector<sf::Vector2u> coords;
+    std::vector<GlyphTileMap::Tile> tiles;
+
+private:
+
+    sf::Uint32 next(std::size_t bound)
+    {
+        return static_cast<sf::Uint32>(m_random() % bound);
+    }
+
+    sf::Color color()
+    {
+        return sf::Color(next(256), next(256), next(256));
+    }
+
+    std::mt19937 m_random;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+std::string formatArea(const sf::Vector2u& area)
+{
+    return std::to_string(area.x) + "x" + std::to_string(area.y);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Runs body once to warm up and then options.repeats times, printing one
+/// CSV row.
+///////////////////////////////////////////////////////////////////////////////
+void run(const Options& options, const std::string& name,
+    const sf::Vector2u& area, sf::Uint32 operations,
+    const std::function<void()>& body)
+{
+    if (name.find(options.filter) == std::string::npos) {
+        return;
+    }
+
+    std::vector<double> samples;
+
+    for (sf::Uint32 i = 0; i <= options.repeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto end = std::chrono::steady_clock::now();
+
+        if (i > 0) {
+            samples.push_back(std::chrono::duration<double, std::nano>(
+                end - start).count() / operations);
+        }
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    std::cout << name << "," << formatArea(area) << "," << operations << ","
+        << options.repeats << "," << samples.front() << ","
+        << samples[samples.size() / 2] << std::endl;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void benchUpdates(const Options& options, sf::Font& font,
+    const sf::Vector2u& area)
+{
+    const sf::Uint32 operations = 100000;
+    Inputs inputs(area, operations);
+    GlyphTileMap tileMap(font, area, {8, 16}, 14);
+    tileMap.prewarmGlyphs(Inputs::getCharset());
+
+    run(options, "setTile", area, operations, [&]() {
+        for (sf::Uint32 i = 0; i < operations; ++i) {
+            tileMap.setTile(inputs.coords[i], inputs.tiles[i]);
+        }
+    });
+
+    run(options, "setTileCharacter", area, operations, [&]() {
+        for (sf::Uint32 i = 0; i < operations; ++i) {
+            tileMap.setTileCharacter(inputs.coords[i],
+                inputs.tiles[i].character, inputs.tiles[i].type);
+        }
+    });
+
+    run(options, "setTileForeground", area, operations, [&]() {
+        for (sf::Uint32 i = 0; i < operations; ++i) {
+            tileMap.setTileForeground(inputs.coords[i],
+                inputs.tiles[i].foreground);
+        }
+    });
+
+    run(options, "setTileBackground", area, operations, [&]() {
+        for (sf::Uint32 i = 0; i < operations; ++i) {
+            tileMap.setTileBackground(inputs.coords[i],
+                inputs.tiles[i].background);
+        }
+    });
+
+    tileMap.setDeferred(true);
+
+    run(options, "setTileDeferred", area, operations, [&]() {
+        for (sf::Uint32 i = 0; i < operations; ++i) {
+            tileMap.setTile(inputs.coords[i], inputs.tiles[i]);
+        }
+        tileMap.commit();
+    });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void benchBulk(const Options& options, sf::Font& font,
+    const sf::Vector2u& area)
+{
+    sf::Uint32 tileCount = area.x * area.y;
+    Inputs inputs(area, tileCount);
+    GlyphTileMap tileMap(font, area, {8, 16}, 14);
+    tileMap.prewarmGlyphs(Inputs::getCharset());
+
+    run(options, "setTiles", area, tileCount, [&]() {
+        tileMap.setTiles({0, 0}, area, inputs.tiles.data());
+    });
+
+    run(options, "fillTiles", area, tileCount, [&]() {
+        tileMap.fillTiles({0, 0}, area, inputs.tiles[0]);
+    });
+
+    run(options, "fillTileForeground", area, tileCount, [&]() {
+        tileMap.fillTileForeground({0, 0}, area, inputs.tiles[0].foreground);
+    });
+
+    // Stamp a 40x20 prefab all over the map, as when composing screens.
+    const sf::Vector2u stampArea(40, 20);
+    const sf::Uint32 stamps = 256;
+    GlyphTileMap stamp(font, stampArea, {8, 16}, 14);
+    stamp.setTiles({0, 0}, stampArea, inputs.tiles.data());
+    run(options, "blit", area, stamps * stampArea.x * stampArea.y, [&]() {
+        for (sf::Uint32 i = 0; i < stamps; ++i) {
+            tileMap.blit(stamp, {0, 0}, stampArea, {
+                inputs.coords[i].x % (area.x - stampArea.x + 1),
+                inputs.coords[i].y % (area.y - stampArea.y + 1)});
+        }
+    });
+
+    // Pan down a row at a time, filling in each exposed row.
+    const sf::Uint32 scrolls = 256;
+    run(options, "scrollAndFillRow", area, scrolls, [&]() {
+        for (sf::Uint32 i = 0; i < scrolls; ++i) {
+            tileMap.scroll(0, 1);
+            tileMap.setTileRow(area.y - 1,
+                &inputs.tiles[(i * area.x) % (tileCount - area.x + 1)]);
+        }
+    });
+
+    tileMap.setDeferred(true);
+    tileMap.setTiles({0, 0}, area, inputs.tiles.data());
+
+    run(options, "rebuild1", area, tileCount, [&]() {
+        tileMap.rebuild(1);
+    });
+
+    run(options, "rebuild", area, tileCount, [&]() {
+        tileMap.rebuild();
+    });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void benchAnimator(const Options& options, sf::Font& font,
+    const sf::Vector2u& area)
+{
+    const sf::Uint32 animations = 10000;
+    Inputs inputs(area, animations);
+    GlyphTileMap tileMap(font, area, {8, 16}, 14);
+    tileMap.prewarmGlyphs(Inputs::getCharset());
+    tileMap.fillTiles({0, 0}, area, inputs.tiles[0]);
+
+    // A third each of blinks, looping fades and palette cycles, on random
+    // tiles and both channels, with periods that never finish them.
+    GlyphTileAnimator animator(tileMap);
+    const std::vector<sf::Color> palette = {sf::Color::Red,
+        sf::Color::Yellow, sf::Color::Green, sf::Color::Cyan,
+        sf::Color::Blue, sf::Color::Magenta};
+
+    for (sf::Uint32 i = 0; i < animations; ++i) {
+        GlyphTileAnimator::Channel channel = (i / 3) % 2 == 0
+            ? GlyphTileAnimator::Foreground : GlyphTileAnimator::Background;
+        const GlyphTileMap::Tile& tile = inputs.tiles[i];
+        sf::Int32 period = 200 + static_cast<sf::Int32>(i % 7) * 100;
+
+        if (i % 3 == 0) {
+            animator.addBlink(inputs.coords[i], {1, 1}, channel,
+                tile.foreground, tile.background, sf::milliseconds(period));
+        } else if (i % 3 == 1) {
+            animator.addLerp(inputs.coords[i], {1, 1}, channel,
+                tile.foreground, tile.background, sf::milliseconds(period),
+                GlyphTileAnimator::PingPong);
+        } else {
+            animator.addPaletteCycle(inputs.coords[i], {1, 1}, channel,
+                palette, sf::milliseconds(period / 4));
+        }
+    }
+
+    // One operation is one tick of every animation at 60 frames a second.
+    const sf::Uint32 ticks = 60;
+    run(options, "animatorTick", area, ticks, [&]() {
+        for (sf::Uint32 i = 0; i < ticks; ++i) {
+            animator.tick(sf::microseconds(16667));
+        }
+    });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// QuadInputs are random per-quad kernel inputs, with fractional and negative
+/// positions as a scrolled map produces.
+///////////////////////////////////////////////////////////////////////////////
+struct QuadInputs {
+    explicit QuadInputs(sf::Uint32 count)
+    {
+        std::mt19937 random(2);
+        std::uniform_real_distribution<float> position(-4096.f, 4096.f);
+        std::uniform_real_distribution<float> size(0.f, 64.f);
+
+        for (sf::Uint32 i = 0; i < count; ++i) {
+            x.push_back(position(random));
+            y.push_back(position(random));
+            left.push_back(size(random) * 16.f);
+            top.push_back(size(random) * 16.f);
+            width.push_back(size(random));
+            height.push_back(size(random));
+            color.push_back(sf::Color(random()));
+        }
+    }
+
+    QuadRun getRun(sf::Uint32 offset) const
+    {
+        return {&x[offset], &y[offset], &left[offset], &top[offset],
+            &width[offset], &height[offset], &color[offset]};
+    }
+
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> left;
+    std::vector<float> top;
+    std::vector<float> width;
+    std::vector<float> height;
+    std::vector<sf::Color> color;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+bool checkKernels()
+{
+#ifdef QUAD_KERNELS_SSE2
+    // Every run length up to a few batches, so each remainder after the
+    // four-quad loop is covered, starting at unaligned offsets.
+    const sf::Uint32 maxCount = 67;
+    QuadInputs inputs(maxCount + 3);
+    std::vector<sf::Vertex> scalar(maxCount * 4);
+    std::vector<sf::Vertex> sse2(maxCount * 4);
+
+    for (sf::Uint32 count = 0; count <= maxCount; ++count) {
+        QuadRun run = inputs.getRun(count % 4);
+
+        std::fill(scalar.begin(), scalar.end(), sf::Vertex());
+        std::fill(sse2.begin(), sse2.end(), sf::Vertex());
+        writeQuadsScalar(scalar.data(), run, count);
+        writeQuadsSSE2(sse2.data(), run, count);
+
+        if (std::memcmp(scalar.data(), sse2.data(),
+            scalar.size() * sizeof(sf::Vertex)) != 0) {
+            std::cerr << "writeQuadsSSE2 differs from writeQuadsScalar for "
+                << count << " quads" << std::endl;
+            return false;
+        }
+    }
+#endif
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void benchKernels(const Options& options, const sf::Vector2u& area)
+{
+    sf::Uint32 tileCount = area.x * area.y;
+    QuadInputs inputs(tileCount);
+    std::vector<sf::Vertex> quads(tileCount * 4);
+
+    // Runs are QuadRunSize quads long, as GlyphTileMap batches them.
+    const sf::Uint32 runSize = 64;
+    auto write = [&](void (*kernel)(sf::Vertex*, const QuadRun&,
+        std::size_t)) {
+        for (sf::Uint32 i = 0; i < tileCount; i += runSize) {
+            kernel(&quads[i * 4], inputs.getRun(i),
+                std::min(runSize, tileCount - i));
+        }
+    };
+
+    run(options, "writeQuadsScalar", area, tileCount, [&]() {
+        write(writeQuadsScalar);
+    });
+
+#ifdef QUAD_KERNELS_SSE2
+    run(options, "writeQuadsSSE2", area, tileCount, [&]() {
+        write(writeQuadsSSE2);
+    });
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void benchDraw(const Options& options, sf::Font& font,
+    const sf::Vector2u& area)
+{
+    sf::RenderTexture frame;
+    if (!frame.create(1024, 1024)) {
+        std::cerr << "skipping draw at " << formatArea(area)
+            << ": no OpenGL context" << std::endl;
+        return;
+    }
+
+    sf::Uint32 tileCount = area.x * area.y;
+    Inputs inputs(area, tileCount);
+    GlyphTileMap tileMap(font, area, {8, 16}, 14);
+    tileMap.prewarmGlyphs(Inputs::getCharset());
+    tileMap.setTiles({0, 0}, area, inputs.tiles.data());
+
+    // glFinish makes the timings include the GPU's work, not just its
+    // submission.
+    const sf::Uint32 frames = 60;
+    run(options, "draw", area, frames, [&]() {
+        for (sf::Uint32 i = 0; i < frames; ++i) {
+            frame.clear();
+            frame.draw(tileMap);
+            frame.display();
+        }
+        glFinish();
+    });
+
+    run(options, "drawAfterColorChange", area, frames, [&]() {
+        for (sf::Uint32 i = 0; i < frames; ++i) {
+            tileMap.setTileBackground(inputs.coords[i], sf::Color::Red);
+            frame.clear();
+            frame.draw(tileMap);
+            frame.display();
+        }
+        glFinish();
+    });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool parseOptions(int argc, char** argv, Options& options)
+{
+    options.font = GLYPH_TILE_MAP_BENCH_FONT;
+    options.repeats = 5;
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 >= argc) {
+            return false;
+        }
+
+        if (std::strcmp(argv[i], "--font") == 0) {
+            options.font = argv[++i];
+        } else if (std::strcmp(argv[i], "--repeats") == 0) {
+            options.repeats = std::max(1ul, std::strtoul(argv[++i],
+                nullptr, 10));
+        } else if (std::strcmp(argv[i], "--filter") == 0) {
+            options.filter = argv[++i];
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0]
+            << " [--font <path>] [--repeats <n>] [--filter <text>]"
+            << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    sf::Font font;
+    if (!font.loadFromFile(options.font)) {
+        return EXIT_FAILURE;
+    }
+
+    if (!checkKernels()) {
+        return EXIT_FAILURE;
+    }
+
+    const sf::Vector2u areas[] = {{80, 50}, {256, 256}, {1024, 1024}};
+
+    std::cout << "benchmark,area,operations,repeats,best_ns_per_op,"
+        "median_ns_per_op" << std::endl;
+
+    for (const sf::Vector2u& area : areas) {
+        benchUpdates(options, font, area);
+        benchBulk(options, font, area);
+        benchAnimator(options, font, area);
+        benchKernels(options, area);
+        benchDraw(options, font, area);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,276 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       BakedGlyphAtlas.cpp
+/// License:        MIT
+/// Description:    A glyph atlas and its metrics baked ahead of time into a
+///                 single file, loaded by memory-mapping it instead of
+///                 rasterizing glyphs through sf::Font.
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BakedGlyphAtlas.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// Every baked file starts with these four bytes and a version number, which
+/// is bumped whenever the layout changes.
+///////////////////////////////////////////////////////////////////////////////
+const char Magic[4] = {'G', 'T', 'M', 'A'};
+const sf::Uint32 Version = 1;
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Uint32 MaxCodepoint = 0x10FFFF;
+const sf::Uint32 ReplacementCharacter = 0xFFFD;
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+BakedGlyphAtlas::BakedGlyphAtlas()
+    : m_file()
+    , m_entries(nullptr)
+    , m_glyphCount(0)
+    , m_characterSize(0)
+    , m_pixels(nullptr)
+    , m_atlasSize(0, 0)
+    , m_texture()
+    , m_textureLoaded(false)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+bool BakedGlyphAtlas::bake(sf::Font& font, sf::Uint32 characterSize,
+    const std::vector<sf::Uint32>& codepoints, const std::string& filename)
+{
+    std::vector<sf::Uint32> sorted(codepoints);
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    sorted.erase(std::upper_bound(sorted.begin(), sorted.end(),
+        MaxCodepoint), sorted.end());
+
+    std::vector<Entry> entries;
+    entries.reserve(sorted.size());
+
+    for (sf::Uint32 codepoint : sorted) {
+        const sf::Glyph& glyph = font.getGlyph(codepoint, characterSize,
+            false);
+        Entry entry = {codepoint,
+            {glyph.textureRect.left, glyph.textureRect.top,
+                glyph.textureRect.width, glyph.textureRect.height},
+            {glyph.bounds.left, glyph.bounds.top, glyph.bounds.width,
+                glyph.bounds.height},
+            glyph.advance};
+
+        entries.push_back(entry);
+    }
+
+    // The atlas is only copied once every glyph is in it, since rasterizing
+    // may grow it.
+    sf::Image atlas = font.getTexture(characterSize).copyToImage();
+    Header header = {{Magic[0], Magic[1], Magic[2], Magic[3]}, Version,
+        characterSize, static_cast<sf::Uint32>(entries.size()),
+        atlas.getSize().x, atlas.getSize().y};
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) {
+        sf::err() << "Failed to open \"" << filename << "\" for writing"
+            << std::endl;
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!entries.empty()) {
+        file.write(reinterpret_cast<const char*>(entries.data()),
+            entries.size() * sizeof(Entry));
+    }
+    if (atlas.getPixelsPtr()) {
+        file.write(reinterpret_cast<const char*>(atlas.getPixelsPtr()),
+            static_cast<std::streamsize>(header.atlasWidth)
+            * header.atlasHeight * 4);
+    }
+
+    if (!file) {
+        sf::err() << "Failed to write baked glyph atlas \"" << filename
+            << "\"" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool BakedGlyphAtlas::loadFromFile(const std::string& filename)
+{
+    m_entries = nullptr;
+    m_glyphCount = 0;
+    m_characterSize = 0;
+    m_pixels = nullptr;
+    m_atlasSize = {0, 0};
+    m_textureLoaded = false;
+
+    if (!m_file.open(filename)) {
+        sf::err() << "Failed to map baked glyph atlas \"" << filename << "\""
+            << std::endl;
+        return false;
+    }
+
+    Header header;
+    std::size_t entriesSize = 0;
+    std::size_t pixelsSize = 0;
+
+    if (m_file.getSize() >= sizeof(Header)) {
+        std::memcpy(&header, m_file.getData(), sizeof(Header));
+        entriesSize = static_cast<std::size_t>(header.glyphCount)
+            * sizeof(Entry);
+        pixelsSize = static_cast<std::size_t>(header.atlasWidth)
+            * header.atlasHeight * 4;
+    }
+
+    if (m_file.getSize() < sizeof(Header)
+        || std::memcmp(header.magic, Magic, sizeof(Magic)) != 0
+        || header.version != Version
+        || m_file.getSize() != sizeof(Header) + entriesSize + pixelsSize) {
+        sf::err() << "Failed to load baked glyph atlas \"" << filename
+            << "\" (not a baked glyph atlas, or baked by another version)"
+            << std::endl;
+        m_file.close();
+        return false;
+    }
+
+    // Entries and pixels are read in place; the pixels are only uploaded to
+    // a texture once one is asked for.
+    const sf::Uint8* data = m_file.getData() + sizeof(Header);
+    m_entries = reinterpret_cast<const Entry*>(data);
+    m_pixels = data + entriesSize;
+    m_atlasSize = {header.atlasWidth, header.atlasHeight};
+    m_glyphCount = header.glyphCount;
+    m_characterSize = header.characterSize;
+
+    // Lookups binary search the entries and the CPU renderer reads texels
+    // through their rects without bounds checks, so a damaged file must not
+    // get this far.
+    if (!hasValidEntries()) {
+        sf::err() << "Failed to load baked glyph atlas \"" << filename
+            << "\" (glyphs are out of order or outside the atlas)"
+            << std::endl;
+        m_entries = nullptr;
+        m_glyphCount = 0;
+        m_characterSize = 0;
+        m_pixels = nullptr;
+        m_atlasSize = {0, 0};
+        m_file.close();
+        return false;
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 BakedGlyphAtlas::getCharacterSize() const
+{
+    return m_characterSize;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 BakedGlyphAtlas::getGlyphCount() const
+{
+    return m_glyphCount;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool BakedGlyphAtlas::hasGlyph(sf::Uint32 codepoint) const
+{
+    return findEntry(codepoint) != nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Glyph BakedGlyphAtlas::getGlyph(sf::Uint32 codepoint) const
+{
+    const Entry* entry = findEntry(codepoint);
+    sf::Glyph glyph;
+
+    if (!entry) {
+        entry = findEntry(ReplacementCharacter);
+    }
+
+    if (entry) {
+        glyph.advance = entry->advance;
+        glyph.bounds = sf::FloatRect(entry->bounds[0], entry->bounds[1],
+            entry->bounds[2], entry->bounds[3]);
+        glyph.textureRect = sf::IntRect(entry->textureRect[0],
+            entry->textureRect[1], entry->textureRect[2],
+            entry->textureRect[3]);
+    }
+
+    return glyph;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Texture& BakedGlyphAtlas::getTexture() const
+{
+    if (!m_textureLoaded && m_pixels) {
+        if (m_texture.create(m_atlasSize.x, m_atlasSize.y)) {
+            m_texture.update(m_pixels);
+            m_texture.setSmooth(true);
+        }
+        m_textureLoaded = true;
+    }
+
+    return m_texture;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Uint8* BakedGlyphAtlas::getPixels() const
+{
+    return m_pixels;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Vector2u& BakedGlyphAtlas::getAtlasSize() const
+{
+    return m_atlasSize;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool BakedGlyphAtlas::hasValidEntries() const
+{
+    sf::Int64 width = m_atlasSize.x;
+    sf::Int64 height = m_atlasSize.y;
+
+    for (sf::Uint32 i = 0; i < m_glyphCount; ++i) {
+        const Entry& entry = m_entries[i];
+        const sf::Int32* rect = entry.textureRect;
+
+        if (i > 0 && entry.codepoint <= m_entries[i - 1].codepoint) {
+            return false;
+        }
+
+        if (rect[0] < 0 || rect[1] < 0 || rect[2] < 0 || rect[3] < 0
+            || rect[0] + static_cast<sf::Int64>(rect[2]) > width
+            || rect[1] + static_cast<sf::Int64>(rect[3]) > height) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const BakedGlyphAtlas::Entry* BakedGlyphAtlas::findEntry(
+    sf::Uint32 codepoint) const
+{
+    const Entry* end = m_entries + m_glyphCount;
+    const Entry* entry = std::lower_bound(m_entries, end, codepoint,
+        [](const Entry& lhs, sf::Uint32 rhs) {
+            return lhs.codepoint < rhs;
+        });
+
+    return (entry != end && entry->codepoint == codepoint) ? entry : nullptr;
+}
@@ -0,0 +1,175 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       BakedGlyphAtlas.h
+/// License:        MIT
+/// Description:    A glyph atlas and its metrics baked ahead of time into a
+///                 single file, loaded by memory-mapping it instead of
+///                 rasterizing glyphs through sf::Font.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BAKED_GLYPH_ATLAS_H
+#define BAKED_GLYPH_ATLAS_H
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <vector>
+
+#include <SFML/System.hpp>
+#include <SFML/Graphics.hpp>
+
+#include "MappedFile.h"
+
+class BakedGlyphAtlas : sf::NonCopyable {
+public:
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Default constructor
+    ///
+    /// Creates an empty atlas with no glyphs.
+    ///////////////////////////////////////////////////////////////////////////
+    BakedGlyphAtlas();
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Rasterizes glyphs with an sf::Font and writes them to a file
+    ///
+    /// The file holds a header, a table of glyph metrics sorted by codepoint
+    /// and the RGBA pixels of the font's atlas texture, which keeps the
+    /// white texel sf::Font reserves at its top left corner. Values are
+    /// stored in the byte order of the machine that baked the file. Bake one
+    /// file per character size.
+    ///
+    /// \param font             Font to rasterize the glyphs with
+    /// \param characterSize    Character size to rasterize the glyphs at
+    /// \param codepoints       Codepoints to bake (duplicates are ignored)
+    /// \param filename         Path of the file to write
+    ///
+    /// \return true if the file was written
+    ///////////////////////////////////////////////////////////////////////////
+    static bool bake(sf::Font& font, sf::Uint32 characterSize,
+        const std::vector<sf::Uint32>& codepoints,
+        const std::string& filename);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Loads a file written by bake()
+    ///
+    /// The file is memory-mapped and stays mapped for glyph lookups. The
+    /// atlas pixels are read in place and only uploaded to a texture the
+    /// first time getTexture() is called. Files whose glyphs are not sorted
+    /// by codepoint or lie outside the atlas are rejected.
+    ///
+    /// \param filename Path of the file to load
+    ///
+    /// \return true if the file was loaded
+    ///////////////////////////////////////////////////////////////////////////
+    bool loadFromFile(const std::string& filename);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the character size the atlas was baked at
+    ///
+    /// \return the character size of the atlas
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint32 getCharacterSize() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of baked glyphs
+    ///
+    /// \return the number of glyphs in the atlas
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint32 getGlyphCount() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns whether a codepoint was baked
+    ///
+    /// \param codepoint    Codepoint to look up
+    ///
+    /// \return true if the atlas holds a glyph for codepoint
+    ///////////////////////////////////////////////////////////////////////////
+    bool hasGlyph(sf::Uint32 codepoint) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the glyph of a codepoint
+    ///
+    /// Codepoints that were not baked fall back to U+FFFD if that was baked,
+    /// or to an empty glyph otherwise.
+    ///
+    /// \param codepoint    Codepoint to look up
+    ///
+    /// \return the glyph of codepoint, as sf::Font::getGlyph would return it
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Glyph getGlyph(sf::Uint32 codepoint) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the atlas texture
+    ///
+    /// The pixels are uploaded on the first call, so an atlas that is only
+    /// read on the CPU never needs an OpenGL context.
+    ///
+    /// \return a const reference to the atlas texture
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Texture& getTexture() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the RGBA pixels of the atlas, read from the mapped file
+    ///
+    /// \return a pointer to getAtlasSize().x * getAtlasSize().y * 4 bytes, or
+    ///         nullptr if no atlas is loaded
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Uint8* getPixels() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the size of the atlas in pixels
+    ///
+    /// \return a const reference to the size of the atlas
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Vector2u& getAtlasSize() const;
+
+private:
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// Header is the start of a baked file. It is followed by glyphCount
+    /// Entries and then atlasWidth * atlasHeight RGBA pixels.
+    ///////////////////////////////////////////////////////////////////////////
+    struct Header {
+        char magic[4];
+        sf::Uint32 version;
+        sf::Uint32 characterSize;
+        sf::Uint32 glyphCount;
+        sf::Uint32 atlasWidth;
+        sf::Uint32 atlasHeight;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// Entry holds the metrics of one glyph.
+    ///////////////////////////////////////////////////////////////////////////
+    struct Entry {
+        sf::Uint32 codepoint;
+        sf::Int32 textureRect[4];
+        float bounds[4];
+        float advance;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const Entry* findEntry(sf::Uint32 codepoint) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool hasValidEntries() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    MappedFile m_file;
+    const Entry* m_entries;
+    sf::Uint32 m_glyphCount;
+    sf::Uint32 m_characterSize;
+    const sf::Uint8* m_pixels;
+    sf::Vector2u m_atlasSize;
+    mutable sf::Texture m_texture;
+    mutable bool m_textureLoaded;
+};
+
+#endif
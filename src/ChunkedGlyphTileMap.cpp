@@ -0,0 +1,290 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       ChunkedGlyphTileMap.cpp
+/// License:        MIT
+/// Description:    A GlyphTileMap for very large worlds, split into lazily
+///                 allocated chunks of which only the ones inside the
+///                 target's view are drawn.
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ChunkedGlyphTileMap.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Uint32 DefaultChunkSize = 64;
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Vector2u getValidChunkArea(const sf::Vector2u& chunkArea)
+{
+    // Chunk coordinates are found by dividing by the chunk area, so an empty
+    // chunk area is replaced by the default one.
+    if (chunkArea.x > 0 && chunkArea.y > 0) {
+        return chunkArea;
+    }
+
+    sf::err() << "Chunk area " << chunkArea.x << "x" << chunkArea.y
+        << " is empty, using " << DefaultChunkSize << "x"
+        << DefaultChunkSize << " instead" << std::endl;
+
+    return {DefaultChunkSize, DefaultChunkSize};
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+ChunkedGlyphTileMap::ChunkedGlyphTileMap(sf::Font& font,
+    const sf::Vector2u& area, const sf::Vector2u& spacing,
+    sf::Uint32 characterSize, const sf::Vector2u& chunkArea)
+    : m_glyphCache(std::make_shared<GlyphCache>(font, characterSize,
+        spacing))
+    , m_area(area)
+    , m_spacing(spacing)
+    , m_chunkArea(getValidChunkArea(chunkArea))
+    , m_chunkCount((area.x + m_chunkArea.x - 1) / m_chunkArea.x,
+        (area.y + m_chunkArea.y - 1) / m_chunkArea.y)
+    , m_chunks(m_chunkCount.x * m_chunkCount.y)
+    , m_allocatedChunks(0)
+    , m_drawnChunks(0)
+    , m_deferred(false)
+    , m_blank(L' ', Tile::Center, sf::Color::White, sf::Color::Transparent)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Vector2u& ChunkedGlyphTileMap::getArea() const
+{
+    return m_area;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Vector2u& ChunkedGlyphTileMap::getSpacing() const
+{
+    return m_spacing;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 ChunkedGlyphTileMap::getCharacterSize() const
+{
+    return m_glyphCache->getCharacterSize();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Vector2u& ChunkedGlyphTileMap::getChunkArea() const
+{
+    return m_chunkArea;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 ChunkedGlyphTileMap::getAllocatedChunkCount() const
+{
+    return m_allocatedChunks;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 ChunkedGlyphTileMap::getDrawnChunkCount() const
+{
+    return m_drawnChunks;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+ChunkedGlyphTileMap::Tile ChunkedGlyphTileMap::getTile(
+    const sf::Vector2u& coords) const
+{
+    const std::unique_ptr<GlyphTileMap>& chunk =
+        m_chunks[getChunkIndex(coords)];
+
+    return chunk ? chunk->getTile(getLocalCoords(coords)) : m_blank;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ChunkedGlyphTileMap::setTile(const sf::Vector2u& coords,
+    const Tile& tile)
+{
+    getChunk(coords).setTile(getLocalCoords(coords), tile);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ChunkedGlyphTileMap::setTileCharacter(const sf::Vector2u& coords,
+    wchar_t character, Tile::Type type, const sf::Vector2i& offset)
+{
+    getChunk(coords).setTileCharacter(getLocalCoords(coords), character,
+        type, offset);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ChunkedGlyphTileMap::setTileForeground(const sf::Vector2u& coords,
+    const sf::Color& color)
+{
+    getChunk(coords).setTileForeground(getLocalCoords(coords), color);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ChunkedGlyphTileMap::setTileBackground(const sf::Vector2u& coords,
+    const sf::Color& color)
+{
+    getChunk(coords).setTileBackground(getLocalCoords(coords), color);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ChunkedGlyphTileMap::fillTiles(const sf::Vector2u& coords,
+    const sf::Vector2u& area, const Tile& tile)
+{
+    if (coords.x >= m_area.x || coords.y >= m_area.y) {
+        return;
+    }
+
+    sf::Vector2u end(std::min(coords.x + area.x, m_area.x),
+        std::min(coords.y + area.y, m_area.y));
+
+    for (sf::Uint32 y = coords.y; y < end.y;) {
+        sf::Uint32 rows = std::min(end.y - y, m_chunkArea.y
+            - (y % m_chunkArea.y));
+
+        for (sf::Uint32 x = coords.x; x < end.x;) {
+            sf::Uint32 columns = std::min(end.x - x, m_chunkArea.x
+                - (x % m_chunkArea.x));
+
+            getChunk({x, y}).fillTiles(getLocalCoords({x, y}),
+                {columns, rows}, tile);
+            x += columns;
+        }
+
+        y += rows;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ChunkedGlyphTileMap::releaseChunk(const sf::Vector2u& chunkCoords)
+{
+    std::unique_ptr<GlyphTileMap>& chunk =
+        m_chunks[(chunkCoords.y * m_chunkCount.x) + chunkCoords.x];
+
+    if (chunk) {
+        chunk.reset();
+        --m_allocatedChunks;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ChunkedGlyphTileMap::setDeferred(bool deferred)
+{
+    m_deferred = deferred;
+
+    for (std::unique_ptr<GlyphTileMap>& chunk : m_chunks) {
+        if (chunk) {
+            chunk->setDeferred(deferred);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ChunkedGlyphTileMap::draw(sf::RenderTarget& target,
+    sf::RenderStates states) const
+{
+    states.transform *= getTransform();
+    m_drawnChunks = 0;
+
+    // Glyphs may hang over the edge of their tile, so the visible range is
+    // padded by the furthest any chunk's glyphs reach, and by at least a tile
+    // for glyphs not placed yet.
+    sf::Vector2u overhang(1, 1);
+
+    for (const std::unique_ptr<GlyphTileMap>& chunk : m_chunks) {
+        if (chunk) {
+            overhang.x = std::max(overhang.x, chunk->getGlyphOverhang().x);
+            overhang.y = std::max(overhang.y, chunk->getGlyphOverhang().y);
+        }
+    }
+
+    // Bring the view's bounds into tile space.
+    const sf::View& view = target.getView();
+    sf::FloatRect visible = states.transform.getInverse().transformRect(
+        view.getInverseTransform().transformRect({-1.f, -1.f, 2.f, 2.f}));
+
+    float padX = static_cast<float>(overhang.x * m_spacing.x);
+    float padY = static_cast<float>(overhang.y * m_spacing.y);
+    float chunkWidth = static_cast<float>(m_chunkArea.x * m_spacing.x);
+    float chunkHeight = static_cast<float>(m_chunkArea.y * m_spacing.y);
+    float left = (visible.left - padX) / chunkWidth;
+    float top = (visible.top - padY) / chunkHeight;
+    float right = (visible.left + visible.width + padX) / chunkWidth;
+    float bottom = (visible.top + visible.height + padY) / chunkHeight;
+
+    sf::Uint32 beginX = static_cast<sf::Uint32>(std::max(0.f,
+        std::floor(left)));
+    sf::Uint32 beginY = static_cast<sf::Uint32>(std::max(0.f,
+        std::floor(top)));
+    sf::Uint32 endX = static_cast<sf::Uint32>(std::min(
+        static_cast<float>(m_chunkCount.x), std::max(0.f, std::ceil(right))));
+    sf::Uint32 endY = static_cast<sf::Uint32>(std::min(
+        static_cast<float>(m_chunkCount.y), std::max(0.f, std::ceil(bottom))));
+
+    // Every background goes beneath every glyph, as in a single GlyphTileMap,
+    // so glyphs hanging into a neighbouring chunk are not painted over.
+    for (sf::Uint32 y = beginY; y < endY; ++y)
+    for (sf::Uint32 x = beginX; x < endX; ++x) {
+        const std::unique_ptr<GlyphTileMap>& chunk =
+            m_chunks[(y * m_chunkCount.x) + x];
+
+        if (chunk) {
+            chunk->drawBackground(target, states);
+            ++m_drawnChunks;
+        }
+    }
+
+    for (sf::Uint32 y = beginY; y < endY; ++y)
+    for (sf::Uint32 x = beginX; x < endX; ++x) {
+        const std::unique_ptr<GlyphTileMap>& chunk =
+            m_chunks[(y * m_chunkCount.x) + x];
+
+        if (chunk) {
+            chunk->drawForeground(target, states);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 ChunkedGlyphTileMap::getChunkIndex(const sf::Vector2u& coords)
+    const
+{
+    return ((coords.y / m_chunkArea.y) * m_chunkCount.x)
+        + (coords.x / m_chunkArea.x);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Vector2u ChunkedGlyphTileMap::getLocalCoords(const sf::Vector2u& coords)
+    const
+{
+    return {coords.x % m_chunkArea.x, coords.y % m_chunkArea.y};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+GlyphTileMap& ChunkedGlyphTileMap::getChunk(const sf::Vector2u& coords)
+{
+    std::unique_ptr<GlyphTileMap>& chunk = m_chunks[getChunkIndex(coords)];
+
+    if (!chunk) {
+        sf::Vector2u origin((coords.x / m_chunkArea.x) * m_chunkArea.x,
+            (coords.y / m_chunkArea.y) * m_chunkArea.y);
+        sf::Vector2u area(std::min(m_chunkArea.x, m_area.x - origin.x),
+            std::min(m_chunkArea.y, m_area.y - origin.y));
+
+        // Chunks share one GlyphCache, so each glyph is only looked up and
+        // placed once for the whole world.
+        chunk.reset(new GlyphTileMap(m_glyphCache, area));
+        chunk->setPosition(static_cast<float>(origin.x * m_spacing.x),
+            static_cast<float>(origin.y * m_spacing.y));
+        chunk->setDeferred(m_deferred);
+        ++m_allocatedChunks;
+    }
+
+    return *chunk;
+}
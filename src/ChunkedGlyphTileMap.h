@@ -0,0 +1,203 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       ChunkedGlyphTileMap.h
+/// License:        MIT
+/// Description:    A GlyphTileMap for very large worlds, split into lazily
+///                 allocated chunks of which only the ones inside the
+///                 target's view are drawn.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CHUNKED_GLYPH_TILE_MAP_H
+#define CHUNKED_GLYPH_TILE_MAP_H
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include <memory>
+#include <vector>
+
+#include <SFML/System.hpp>
+#include <SFML/Graphics.hpp>
+
+#include "GlyphCache.h"
+#include "GlyphTileMap.h"
+
+class ChunkedGlyphTileMap : public sf::Drawable, public sf::Transformable {
+public:
+
+    typedef GlyphTileMap::Tile Tile;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor
+    ///
+    /// No vertex storage is allocated up front; each chunk is created as a
+    /// GlyphTileMap the first time one of its tiles is set. All chunks share
+    /// one GlyphCache. An empty chunkArea is reported to sf::err() and
+    /// replaced by {64, 64}.
+    ///
+    /// \param font             Reference to a loaded sf::Font to use for
+    //                          glyph data
+    /// \param area             Width and height of the world in # of tiles
+    /// \param spacing          Width and height of each tile in pixels
+    /// \param characterSize    Size of each glyph
+    /// \param chunkArea        Width and height of each chunk in # of tiles,
+    ///                         which must not be 0 (default {64, 64})
+    ///////////////////////////////////////////////////////////////////////////
+    ChunkedGlyphTileMap(sf::Font& font, const sf::Vector2u& area,
+        const sf::Vector2u& spacing, sf::Uint32 characterSize,
+        const sf::Vector2u& chunkArea = {64, 64});
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a const reference to the area of the world in tiles
+    ///
+    /// \return a const reference to the area of the world in tiles
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Vector2u& getArea() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a const reference to the spacing of the tiles
+    ///
+    /// \return a const reference to the spacing of the tiles
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Vector2u& getSpacing() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the character size of the tiles
+    ///
+    /// \return the character size of the tiles
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint32 getCharacterSize() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a const reference to the area of each chunk in tiles
+    ///
+    /// \return a const reference to the area of each chunk in tiles
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Vector2u& getChunkArea() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of chunks that currently own storage
+    ///
+    /// \return the number of allocated chunks
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint32 getAllocatedChunkCount() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of chunks submitted by the last draw
+    ///
+    /// \return the number of chunks drawn by the last draw
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint32 getDrawnChunkCount() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the Tile at a coords
+    ///
+    /// Tiles of unallocated chunks read as blank Tiles.
+    ///
+    /// \param coords   Coordinates in the world to read
+    ///
+    /// \return the Tile at coords
+    ///////////////////////////////////////////////////////////////////////////
+    Tile getTile(const sf::Vector2u& coords) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates the world at a coords with data from a Tile
+    ///
+    /// \param coords   Coordinates in the world to update
+    /// \param tile     GlyphTileMap::Tile to update the world with
+    ///////////////////////////////////////////////////////////////////////////
+    void setTile(const sf::Vector2u& coords, const Tile& tile);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates the character at a coords in the world
+    ///
+    /// \param coords       Coordinates in the world to update
+    /// \param character    New character for the tile
+    /// \param type         Tile::Type of the new character (default Center)
+    /// \param offset       Exact spacing offset value of the new character
+    ///                     (default {0, 0})
+    ///////////////////////////////////////////////////////////////////////////
+    void setTileCharacter(const sf::Vector2u& coords, wchar_t character,
+        Tile::Type type = Tile::Center, const sf::Vector2i& offset = {0, 0});
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates the foreground color at a coords in the world
+    ///
+    /// \param coords   Coordinates in the world to update
+    /// \param color    New foreground color for the tile
+    ///////////////////////////////////////////////////////////////////////////
+    void setTileForeground(const sf::Vector2u& coords, const sf::Color& color);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates the background color at a coords in the world
+    ///
+    /// \param coords   Coordinates in the world to update
+    /// \param color    New background color for the tile
+    ///////////////////////////////////////////////////////////////////////////
+    void setTileBackground(const sf::Vector2u& coords, const sf::Color& color);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates a rectangle of the world with data from a Tile
+    ///
+    /// The rectangle is clipped to the world and split along chunk borders.
+    ///
+    /// \param coords   Coordinates of the top left tile of the rectangle
+    /// \param area     Width and height of the rectangle in # of tiles
+    /// \param tile     GlyphTileMap::Tile to fill the rectangle with
+    ///////////////////////////////////////////////////////////////////////////
+    void fillTiles(const sf::Vector2u& coords, const sf::Vector2u& area,
+        const Tile& tile);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Frees the storage of a chunk, resetting its tiles to blank
+    ///
+    /// \param chunkCoords  Coordinates of the chunk in # of chunks
+    ///////////////////////////////////////////////////////////////////////////
+    void releaseChunk(const sf::Vector2u& chunkCoords);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Enables or disables deferred vertex generation of all chunks
+    ///
+    /// \param deferred True to defer vertex generation until draw
+    ///
+    /// \see GlyphTileMap::setDeferred
+    ///////////////////////////////////////////////////////////////////////////
+    void setDeferred(bool deferred);
+
+private:
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint32 getChunkIndex(const sf::Vector2u& coords) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Vector2u getLocalCoords(const sf::Vector2u& coords) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    GlyphTileMap& getChunk(const sf::Vector2u& coords);
+
+    ///////////////////////////////////////////////////////////////////////////
+    std::shared_ptr<GlyphCache> m_glyphCache;
+    sf::Vector2u m_area;
+    sf::Vector2u m_spacing;
+    sf::Vector2u m_chunkArea;
+    sf::Vector2u m_chunkCount;
+    std::vector<std::unique_ptr<GlyphTileMap>> m_chunks;
+    sf::Uint32 m_allocatedChunks;
+    mutable sf::Uint32 m_drawnChunks;
+    bool m_deferred;
+    Tile m_blank;
+};
+
+#endif
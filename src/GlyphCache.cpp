@@ -0,0 +1,221 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       GlyphCache.cpp
+/// License:        MIT
+/// Description:    A cache of the glyph metrics and tile placement of every
+///                 character used by a grid of tiles, taken from an sf::Font
+///                 or a BakedGlyphAtlas.
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GlyphCache.h"
+#include "BakedGlyphAtlas.h"
+
+namespace
+{
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Uint32 ReplacementCharacter = 0xFFFD;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Marks the atlas image as never copied.
+///////////////////////////////////////////////////////////////////////////////
+const sf::Uint64 NoAtlasImage = ~static_cast<sf::Uint64>(0);
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+GlyphCache::GlyphCache(sf::Font& font, sf::Uint32 characterSize,
+    const sf::Vector2u& spacing)
+    : m_font(&font)
+    , m_atlas(nullptr)
+    , m_characterSize(characterSize)
+    , m_spacing(spacing)
+    , m_pages()
+    , m_atlasSize(0, 0)
+    , m_hits(0)
+    , m_misses(0)
+    , m_atlasGrowths(0)
+    , m_atlasImage()
+    , m_atlasImageMisses(NoAtlasImage)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+GlyphCache::GlyphCache(const BakedGlyphAtlas& atlas,
+    const sf::Vector2u& spacing)
+    : m_font(nullptr)
+    , m_atlas(&atlas)
+    , m_characterSize(atlas.getCharacterSize())
+    , m_spacing(spacing)
+    , m_pages()
+    , m_atlasSize(0, 0)
+    , m_hits(0)
+    , m_misses(0)
+    , m_atlasGrowths(0)
+    , m_atlasImage()
+    , m_atlasImageMisses(NoAtlasImage)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Font* GlyphCache::getFont() const
+{
+    return m_font;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 GlyphCache::getCharacterSize() const
+{
+    return m_characterSize;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Vector2u& GlyphCache::getSpacing() const
+{
+    return m_spacing;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool GlyphCache::hasSameGlyphs(const GlyphCache& other) const
+{
+    return m_font == other.m_font && m_atlas == other.m_atlas
+        && m_characterSize == other.m_characterSize
+        && m_spacing == other.m_spacing;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Texture& GlyphCache::getTexture() const
+{
+    return m_atlas ? m_atlas->getTexture()
+        : m_font->getTexture(m_characterSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Image& GlyphCache::getAtlasImage()
+{
+    // Only a miss can add pixels this cache's Glyphs refer to.
+    if (m_atlasImageMisses == m_misses) {
+        return m_atlasImage;
+    }
+
+    if (m_atlas) {
+        if (m_atlasImageMisses == NoAtlasImage && m_atlas->getPixels()) {
+            m_atlasImage.create(m_atlas->getAtlasSize().x,
+                m_atlas->getAtlasSize().y, m_atlas->getPixels());
+        }
+    } else {
+        m_atlasImage = m_font->getTexture(m_characterSize).copyToImage();
+    }
+
+    m_atlasImageMisses = m_misses;
+
+    return m_atlasImage;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const GlyphCache::Glyph& GlyphCache::get(sf::Uint32 codepoint)
+{
+    if (codepoint > MaxCodepoint) {
+        codepoint = ReplacementCharacter;
+    }
+
+    sf::Uint32 page = codepoint >> PageBits;
+
+    if (page < m_pages.size() && m_pages[page]) {
+        Glyph& cached = m_pages[page][codepoint & (PageSize - 1)];
+
+        if (cached.loaded) {
+            ++m_hits;
+            return cached;
+        }
+    }
+
+    ++m_misses;
+
+    sf::Glyph glyph;
+
+    if (m_atlas) {
+        glyph = m_atlas->getGlyph(codepoint);
+    } else {
+        // Growing the atlas keeps glyphs where they are. A reloaded font
+        // invalidates them, which is left to the owner to clear().
+        glyph = m_font->getGlyph(codepoint, m_characterSize, false);
+        sf::Vector2u atlasSize = m_font->getTexture(m_characterSize).getSize();
+        if (atlasSize != m_atlasSize && m_atlasSize != sf::Vector2u()) {
+            ++m_atlasGrowths;
+        }
+        m_atlasSize = atlasSize;
+    }
+
+    if (page >= m_pages.size()) {
+        m_pages.resize(page + 1);
+    }
+
+    if (!m_pages[page]) {
+        m_pages[page].reset(new Glyph[PageSize]());
+    }
+
+    Glyph& cached = m_pages[page][codepoint & (PageSize - 1)];
+    load(cached, glyph);
+
+    return cached;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const GlyphCache::Glyph* GlyphCache::find(sf::Uint32 codepoint) const
+{
+    sf::Uint32 page = codepoint >> PageBits;
+
+    if (codepoint > MaxCodepoint || page >= m_pages.size()
+        || !m_pages[page]) {
+        return nullptr;
+    }
+
+    const Glyph& cached = m_pages[page][codepoint & (PageSize - 1)];
+
+    return cached.loaded ? &cached : nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphCache::clear()
+{
+    m_pages.clear();
+    m_atlasSize = {0, 0};
+    m_atlasImageMisses = NoAtlasImage;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint64 GlyphCache::getHits() const
+{
+    return m_hits;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint64 GlyphCache::getMisses() const
+{
+    return m_misses;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 GlyphCache::getAtlasGrowths() const
+{
+    return m_atlasGrowths;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphCache::load(Glyph& cached, const sf::Glyph& glyph) const
+{
+    cached.textureRect = glyph.textureRect;
+    cached.bounds = glyph.bounds;
+    cached.textOffset.x = static_cast<int>(glyph.bounds.left);
+    cached.textOffset.y = static_cast<int>(m_spacing.y + glyph.bounds.top);
+    // Signed, so glyphs larger than a tile overhang it evenly.
+    sf::Vector2i spacing(m_spacing);
+    cached.floorOffset.x = (spacing.x - glyph.textureRect.width) / 2;
+    cached.floorOffset.y = spacing.y - glyph.textureRect.height;
+    cached.centerOffset.x = (spacing.x - glyph.textureRect.width) / 2;
+    cached.centerOffset.y = (spacing.y - glyph.textureRect.height) / 2;
+    cached.loaded = true;
+}
@@ -0,0 +1,201 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       GlyphCache.h
+/// License:        MIT
+/// Description:    A cache of the glyph metrics and tile placement of every
+///                 character used by a grid of tiles, taken from an sf::Font
+///                 or a BakedGlyphAtlas.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include <memory>
+#include <vector>
+
+#include <SFML/System.hpp>
+#include <SFML/Graphics.hpp>
+
+class BakedGlyphAtlas;
+
+class GlyphCache {
+public:
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// Glyph holds the metrics of a glyph along with its offsets within a
+    /// tile for each way of placing it that does not depend on a Tile's
+    /// offset (Exact is center + offset).
+    ///////////////////////////////////////////////////////////////////////////
+    struct Glyph {
+        sf::IntRect textureRect;
+        sf::FloatRect bounds;
+        sf::Vector2i textOffset;
+        sf::Vector2i floorOffset;
+        sf::Vector2i centerOffset;
+        bool loaded;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor taking glyphs from an sf::Font
+    ///
+    /// \param font             Reference to a loaded sf::Font
+    /// \param characterSize    Size of each glyph
+    /// \param spacing          Width and height of each tile in pixels
+    ///////////////////////////////////////////////////////////////////////////
+    GlyphCache(sf::Font& font, sf::Uint32 characterSize,
+        const sf::Vector2u& spacing);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor taking glyphs from a BakedGlyphAtlas
+    ///
+    /// \param atlas    Reference to a loaded BakedGlyphAtlas, which must
+    ///                 outlive the GlyphCache
+    /// \param spacing  Width and height of each tile in pixels
+    ///////////////////////////////////////////////////////////////////////////
+    GlyphCache(const BakedGlyphAtlas& atlas, const sf::Vector2u& spacing);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the font glyphs are taken from
+    ///
+    /// \return a pointer to the sf::Font, or nullptr for a BakedGlyphAtlas
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Font* getFont() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the character size of the glyphs
+    ///
+    /// \return the character size of the glyphs
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint32 getCharacterSize() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the spacing of the tiles glyphs are placed in
+    ///
+    /// \return a const reference to the spacing of the tiles
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Vector2u& getSpacing() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns whether another cache places every glyph identically
+    ///
+    /// Caches of the same sf::Font or BakedGlyphAtlas at the same character
+    /// size and spacing share one texture and compute the same Glyphs, so
+    /// quads built from one are valid for the other.
+    ///
+    /// \param other    GlyphCache to compare with
+    ///
+    /// \return true if the Glyphs of both caches are interchangeable
+    ///////////////////////////////////////////////////////////////////////////
+    bool hasSameGlyphs(const GlyphCache& other) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the texture the glyphs' textureRects refer to
+    ///
+    /// sf::Font and BakedGlyphAtlas both keep a 2x2 block of white texels at
+    /// the top left of this texture, which can be used to draw solid quads.
+    ///
+    /// \return a const reference to the glyph atlas texture
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Texture& getTexture() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a copy of the glyph atlas for drawing on the CPU
+    ///
+    /// A BakedGlyphAtlas is copied from its mapped file once. An sf::Font's
+    /// texture is copied back from the GPU, which needs an OpenGL context,
+    /// and again whenever Glyphs have been loaded since.
+    ///
+    /// \return a const reference to the atlas image, valid until the next
+    ///         call
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Image& getAtlasImage();
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the Glyph of a codepoint, loading it if needed
+    ///
+    /// Codepoints past U+10FFFF are looked up as U+FFFD.
+    ///
+    /// \param codepoint    Codepoint to look up
+    ///
+    /// \return a const reference to the Glyph, valid until the next load
+    ///////////////////////////////////////////////////////////////////////////
+    const Glyph& get(sf::Uint32 codepoint);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the Glyph of a codepoint if it is already loaded
+    ///
+    /// Never touches the sf::Font, so it is safe to call from several threads
+    /// as long as nothing is loaded meanwhile.
+    ///
+    /// \param codepoint    Codepoint to look up
+    ///
+    /// \return a pointer to the Glyph, or nullptr if it is not loaded
+    ///////////////////////////////////////////////////////////////////////////
+    const Glyph* find(sf::Uint32 codepoint) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Discards all loaded Glyphs
+    ///
+    /// Must be called after the sf::Font is reloaded, since the cache cannot
+    /// tell and would keep handing out textureRects of the old font.
+    ///////////////////////////////////////////////////////////////////////////
+    void clear();
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of lookups served by the cache
+    ///
+    /// \return the number of cache hits
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint64 getHits() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of lookups that had to load a Glyph
+    ///
+    /// \return the number of cache misses
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint64 getMisses() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of times loading a Glyph grew the atlas
+    ///
+    /// Only counts growth seen after the first load, and never counts for a
+    /// BakedGlyphAtlas, whose texture has a fixed size.
+    ///
+    /// \return the number of atlas growths
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint32 getAtlasGrowths() const;
+
+private:
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// The cache is a table of pages of PageSize Glyphs indexed by codepoint,
+    /// allocated on first use so sparse charsets stay small.
+    ///////////////////////////////////////////////////////////////////////////
+    static const sf::Uint32 PageBits = 8;
+    static const sf::Uint32 PageSize = 1 << PageBits;
+    static const sf::Uint32 MaxCodepoint = 0x10FFFF;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void load(Glyph& cached, const sf::Glyph& glyph) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Font* m_font;
+    const BakedGlyphAtlas* m_atlas;
+    sf::Uint32 m_characterSize;
+    sf::Vector2u m_spacing;
+    std::vector<std::unique_ptr<Glyph[]>> m_pages;
+    sf::Vector2u m_atlasSize;
+    sf::Uint64 m_hits;
+    sf::Uint64 m_misses;
+    sf::Uint32 m_atlasGrowths;
+    sf::Image m_atlasImage;
+    sf::Uint64 m_atlasImageMisses;
+};
+
+#endif
@@ -0,0 +1,313 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       GlyphTileAnimator.cpp
+/// License:        MIT
+/// Description:    Animates the colors of many tiles of a GlyphTileMap at
+///                 once, advancing every animation in a single tick.
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GlyphTileAnimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// Periods are clamped to a microsecond so a zero period never divides by
+/// zero; a Once lerp of that length finishes on the next tick.
+///////////////////////////////////////////////////////////////////////////////
+const float MinPeriod = 1e-6f;
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint8 lerpComponent(sf::Uint8 from, sf::Uint8 to, float t)
+{
+    return static_cast<sf::Uint8>(from + (to - from) * t + 0.5f);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Color lerpColor(const sf::Color& from, const sf::Color& to, float t)
+{
+    return {
+        lerpComponent(from.r, to.r, t),
+        lerpComponent(from.g, to.g, t),
+        lerpComponent(from.b, to.b, t),
+        lerpComponent(from.a, to.a, t)
+    };
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+GlyphTileAnimator::GlyphTileAnimator(GlyphTileMap& tileMap)
+    : m_tileMap(tileMap)
+    , m_nextId(1)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 GlyphTileAnimator::addBlink(const sf::Vector2u& coords,
+    const sf::Vector2u& area, Channel channel, const sf::Color& on,
+    const sf::Color& off, sf::Time period)
+{
+    return add(Blink, coords, area, channel, on, off, period);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 GlyphTileAnimator::addLerp(const sf::Vector2u& coords,
+    const sf::Vector2u& area, Channel channel, const sf::Color& from,
+    const sf::Color& to, sf::Time duration, Repeat repeat)
+{
+    Kind kind = repeat == Loop ? LerpLoop
+        : repeat == PingPong ? LerpPingPong : LerpOnce;
+
+    return add(kind, coords, area, channel, from, to, duration);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 GlyphTileAnimator::addPaletteCycle(const sf::Vector2u& coords,
+    const sf::Vector2u& area, Channel channel,
+    const std::vector<sf::Color>& palette, sf::Time step)
+{
+    if (palette.empty()) {
+        return 0;
+    }
+
+    sf::Uint32 start = static_cast<sf::Uint32>(m_palettes.size());
+    m_palettes.insert(m_palettes.end(), palette.begin(), palette.end());
+
+    sf::Uint32 id = add(Palette, coords, area, channel, palette.front(),
+        palette.front(), step);
+
+    m_paletteStarts.back() = start;
+    m_paletteSizes.back() = static_cast<sf::Uint32>(palette.size());
+
+    return id;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool GlyphTileAnimator::remove(sf::Uint32 id)
+{
+    auto it = m_slots.find(id);
+
+    if (it == m_slots.end()) {
+        return false;
+    }
+
+    removeSlot(it->second);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool GlyphTileAnimator::isRunning(sf::Uint32 id) const
+{
+    return m_slots.count(id) != 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileAnimator::clear()
+{
+    m_slots.clear();
+    m_ids.clear();
+    m_kinds.clear();
+    m_channels.clear();
+    m_coords.clear();
+    m_areas.clear();
+    m_times.clear();
+    m_periods.clear();
+    m_firstColors.clear();
+    m_secondColors.clear();
+    m_paletteStarts.clear();
+    m_paletteSizes.clear();
+    m_colors.clear();
+    m_palettes.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 GlyphTileAnimator::getAnimationCount() const
+{
+    return static_cast<sf::Uint32>(m_ids.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileAnimator::tick(sf::Time dt)
+{
+    float seconds = dt.asSeconds();
+    sf::Uint32 count = static_cast<sf::Uint32>(m_ids.size());
+
+    m_finished.clear();
+
+    for (sf::Uint32 i = 0; i < count; ++i) {
+        float period = m_periods[i];
+        float time = m_times[i] + seconds;
+        sf::Color color;
+
+        switch (m_kinds[i]) {
+        case Blink:
+            if (time >= period) {
+                time = std::fmod(time, period);
+            }
+            color = time * 2.f < period ? m_firstColors[i] : m_secondColors[i];
+            break;
+        case LerpOnce:
+            if (time >= period) {
+                time = period;
+                m_finished.push_back(i);
+            }
+            color = lerpColor(m_firstColors[i], m_secondColors[i],
+                time / period);
+            break;
+        case LerpLoop:
+            if (time >= period) {
+                time = std::fmod(time, period);
+            }
+            color = lerpColor(m_firstColors[i], m_secondColors[i],
+                time / period);
+            break;
+        case LerpPingPong:
+            if (time >= period * 2.f) {
+                time = std::fmod(time, period * 2.f);
+            }
+            color = lerpColor(m_firstColors[i], m_secondColors[i],
+                time < period ? time / period : 2.f - time / period);
+            break;
+        case Palette:
+            {
+                sf::Uint32 size = m_paletteSizes[i];
+
+                if (time >= period * size) {
+                    time = std::fmod(time, period * size);
+                }
+
+                sf::Uint32 step = std::min(size - 1,
+                    static_cast<sf::Uint32>(time / period));
+                color = m_palettes[m_paletteStarts[i] + step];
+            }
+            break;
+        }
+
+        m_times[i] = time;
+
+        if (color != m_colors[i]) {
+            m_colors[i] = color;
+            writeColor(i);
+        }
+    }
+
+    // Finished lerps are removed last to first, so removing one never moves
+    // another that is still to be removed.
+    for (auto it = m_finished.rbegin(); it != m_finished.rend(); ++it) {
+        removeSlot(*it);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 GlyphTileAnimator::add(Kind kind, const sf::Vector2u& coords,
+    const sf::Vector2u& area, Channel channel, const sf::Color& first,
+    const sf::Color& second, sf::Time period)
+{
+    sf::Uint32 id = m_nextId++;
+
+    if (m_nextId == 0) {
+        m_nextId = 1;
+    }
+
+    m_slots[id] = static_cast<sf::Uint32>(m_ids.size());
+    m_ids.push_back(id);
+    m_kinds.push_back(kind);
+    m_channels.push_back(channel);
+    m_coords.push_back(coords);
+    m_areas.push_back(area);
+    m_times.push_back(0.f);
+    m_periods.push_back(std::max(period.asSeconds(), MinPeriod));
+    m_firstColors.push_back(first);
+    m_secondColors.push_back(second);
+    m_paletteStarts.push_back(0);
+    m_paletteSizes.push_back(0);
+    m_colors.push_back(first);
+
+    writeColor(static_cast<sf::Uint32>(m_ids.size() - 1));
+
+    return id;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileAnimator::removeSlot(sf::Uint32 slot)
+{
+    // A palette's colors are erased from the shared array, shifting the
+    // palettes stored after it. Removals are rare next to ticks, which then
+    // never skip over dead colors.
+    if (m_kinds[slot] == Palette) {
+        sf::Uint32 start = m_paletteStarts[slot];
+        sf::Uint32 size = m_paletteSizes[slot];
+
+        m_palettes.erase(m_palettes.begin() + start,
+            m_palettes.begin() + start + size);
+
+        for (std::size_t i = 0; i < m_ids.size(); ++i) {
+            if (m_kinds[i] == Palette && m_paletteStarts[i] > start) {
+                m_paletteStarts[i] -= size;
+            }
+        }
+    }
+
+    sf::Uint32 last = static_cast<sf::Uint32>(m_ids.size() - 1);
+
+    m_slots.erase(m_ids[slot]);
+
+    if (slot != last) {
+        m_slots[m_ids[last]] = slot;
+        m_ids[slot] = m_ids[last];
+        m_kinds[slot] = m_kinds[last];
+        m_channels[slot] = m_channels[last];
+        m_coords[slot] = m_coords[last];
+        m_areas[slot] = m_areas[last];
+        m_times[slot] = m_times[last];
+        m_periods[slot] = m_periods[last];
+        m_firstColors[slot] = m_firstColors[last];
+        m_secondColors[slot] = m_secondColors[last];
+        m_paletteStarts[slot] = m_paletteStarts[last];
+        m_paletteSizes[slot] = m_paletteSizes[last];
+        m_colors[slot] = m_colors[last];
+    }
+
+    m_ids.pop_back();
+    m_kinds.pop_back();
+    m_channels.pop_back();
+    m_coords.pop_back();
+    m_areas.pop_back();
+    m_times.pop_back();
+    m_periods.pop_back();
+    m_firstColors.pop_back();
+    m_secondColors.pop_back();
+    m_paletteStarts.pop_back();
+    m_paletteSizes.pop_back();
+    m_colors.pop_back();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileAnimator::writeColor(sf::Uint32 slot)
+{
+    const sf::Vector2u& coords = m_coords[slot];
+    const sf::Vector2u& area = m_areas[slot];
+    const sf::Color& color = m_colors[slot];
+
+    // Single tiles, the common case, skip the fill's clipping and run
+    // splitting.
+    if (area.x == 1 && area.y == 1) {
+        if (m_channels[slot] == Foreground) {
+            m_tileMap.setTileForeground(coords, color);
+        } else {
+            m_tileMap.setTileBackground(coords, color);
+        }
+    } else if (m_channels[slot] == Foreground) {
+        m_tileMap.fillTileForeground(coords, area, color);
+    } else {
+        m_tileMap.fillTileBackground(coords, area, color);
+    }
+}
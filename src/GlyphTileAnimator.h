@@ -0,0 +1,192 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       GlyphTileAnimator.h
+/// License:        MIT
+/// Description:    Animates the colors of many tiles of a GlyphTileMap at
+///                 once, advancing every animation in a single tick.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef GLYPH_TILE_ANIMATOR_H
+#define GLYPH_TILE_ANIMATOR_H
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include <unordered_map>
+#include <vector>
+
+#include <SFML/System.hpp>
+#include <SFML/Graphics.hpp>
+
+#include "GlyphTileMap.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// A GlyphTileAnimator drives the foreground or background colors of tiles
+/// or rectangles of tiles of one GlyphTileMap: blinking cursors, flickering
+/// torches, shimmering water, damage flashes. Every animation is advanced by
+/// one call to tick(), and a tile's color is only written to the map when
+/// its animation produces a different color than it last wrote.
+///
+/// Animations are stored as parallel arrays, one element per animation, so
+/// a tick is a tight pass over them whatever their kind.
+///////////////////////////////////////////////////////////////////////////////
+class GlyphTileAnimator : sf::NonCopyable {
+public:
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// Channel selects which color of the tiles an animation drives.
+    ///////////////////////////////////////////////////////////////////////////
+    enum Channel { Foreground, Background };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// Repeat selects what a lerp does once it reaches its end color:
+    ///
+    /// Once:       Stays at the end color and removes itself
+    /// Loop:       Starts again from the start color
+    /// PingPong:   Runs back to the start color, and so on
+    ///////////////////////////////////////////////////////////////////////////
+    enum Repeat { Once, Loop, PingPong };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor
+    ///
+    /// \param tileMap  GlyphTileMap to animate, which must outlive the
+    ///                 GlyphTileAnimator
+    ///////////////////////////////////////////////////////////////////////////
+    explicit GlyphTileAnimator(GlyphTileMap& tileMap);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Adds an animation alternating between two colors
+    ///
+    /// \param coords   Coordinates of the top left tile to animate
+    /// \param area     Width and height of the rectangle to animate in # of
+    ///                 tiles ({1, 1} for a single tile)
+    /// \param channel  Color of the tiles to animate
+    /// \param on       Color of the first half of each period
+    /// \param off      Color of the second half of each period
+    /// \param period   Duration of one on and off cycle
+    ///
+    /// \return the id of the animation
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint32 addBlink(const sf::Vector2u& coords, const sf::Vector2u& area,
+        Channel channel, const sf::Color& on, const sf::Color& off,
+        sf::Time period);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Adds an animation fading linearly from one color to another
+    ///
+    /// \param coords   Coordinates of the top left tile to animate
+    /// \param area     Width and height of the rectangle to animate in # of
+    ///                 tiles ({1, 1} for a single tile)
+    /// \param channel  Color of the tiles to animate
+    /// \param from     Start color
+    /// \param to       End color
+    /// \param duration Duration of the fade
+    /// \param repeat   What to do after reaching to (default Once)
+    ///
+    /// \return the id of the animation
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint32 addLerp(const sf::Vector2u& coords, const sf::Vector2u& area,
+        Channel channel, const sf::Color& from, const sf::Color& to,
+        sf::Time duration, Repeat repeat = Once);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Adds an animation stepping through a palette of colors
+    ///
+    /// \param coords   Coordinates of the top left tile to animate
+    /// \param area     Width and height of the rectangle to animate in # of
+    ///                 tiles ({1, 1} for a single tile)
+    /// \param channel  Color of the tiles to animate
+    /// \param palette  Colors to cycle through, in order
+    /// \param step     Duration of each color
+    ///
+    /// \return the id of the animation, or 0 if the palette is empty
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint32 addPaletteCycle(const sf::Vector2u& coords,
+        const sf::Vector2u& area, Channel channel,
+        const std::vector<sf::Color>& palette, sf::Time step);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Removes an animation, leaving its tiles in their current colors
+    ///
+    /// \param id   Id of the animation to remove
+    ///
+    /// \return true if the animation was still running
+    ///////////////////////////////////////////////////////////////////////////
+    bool remove(sf::Uint32 id);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns whether an animation is still running
+    ///
+    /// \param id   Id of the animation
+    ///
+    /// \return true if the animation has neither finished nor been removed
+    ///////////////////////////////////////////////////////////////////////////
+    bool isRunning(sf::Uint32 id) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Removes every animation
+    ///////////////////////////////////////////////////////////////////////////
+    void clear();
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of running animations
+    ///
+    /// \return the number of running animations
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint32 getAnimationCount() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Advances every animation and writes the colors that changed
+    ///
+    /// \param dt   Time elapsed since the last tick
+    ///////////////////////////////////////////////////////////////////////////
+    void tick(sf::Time dt);
+
+private:
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// Kind is the kind of an animation; Lerps are split by Repeat so a tick
+    /// branches once per animation.
+    ///////////////////////////////////////////////////////////////////////////
+    enum Kind : sf::Uint8 { Blink, LerpOnce, LerpLoop, LerpPingPong, Palette };
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint32 add(Kind kind, const sf::Vector2u& coords,
+        const sf::Vector2u& area, Channel channel, const sf::Color& first,
+        const sf::Color& second, sf::Time period);
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void removeSlot(sf::Uint32 slot);
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void writeColor(sf::Uint32 slot);
+
+    ///////////////////////////////////////////////////////////////////////////
+    GlyphTileMap& m_tileMap;
+    sf::Uint32 m_nextId;
+    std::unordered_map<sf::Uint32, sf::Uint32> m_slots;
+    std::vector<sf::Uint32> m_ids;
+    std::vector<Kind> m_kinds;
+    std::vector<Channel> m_channels;
+    std::vector<sf::Vector2u> m_coords;
+    std::vector<sf::Vector2u> m_areas;
+    std::vector<float> m_times;
+    std::vector<float> m_periods;
+    std::vector<sf::Color> m_firstColors;
+    std::vector<sf::Color> m_secondColors;
+    std::vector<sf::Uint32> m_paletteStarts;
+    std::vector<sf::Uint32> m_paletteSizes;
+    std::vector<sf::Color> m_colors;
+    std::vector<sf::Color> m_palettes;
+    std::vector<sf::Uint32> m_finished;
+};
+
+#endif
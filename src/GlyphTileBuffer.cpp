@@ -0,0 +1,178 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       GlyphTileBuffer.cpp
+/// License:        MIT
+/// Description:    A triple-buffered grid of tiles, written by one thread and
+///                 published lock-free to a GlyphTileMap on another.
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GlyphTileBuffer.h"
+
+#include <algorithm>
+
+namespace
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// The reader starts out having copied no version, so the first frame it
+/// takes is copied whole.
+///////////////////////////////////////////////////////////////////////////////
+const sf::Uint64 NoVersion = ~static_cast<sf::Uint64>(0);
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Uint32 GlyphTileBuffer::IndexMask;
+const sf::Uint32 GlyphTileBuffer::Fresh;
+
+///////////////////////////////////////////////////////////////////////////////
+GlyphTileBuffer::GlyphTileBuffer(const sf::Vector2u& area)
+    : m_area(area)
+    , m_frames()
+    , m_latest(1)
+    , m_back(0)
+    , m_published(1)
+    , m_version(0)
+    , m_dirtyRows(area.y, 0)
+    , m_front(2)
+    , m_copiedVersions(area.y, NoVersion)
+{
+    Tile blank(L' ', Tile::Center, sf::Color::White, sf::Color::Transparent);
+
+    for (Frame& frame : m_frames) {
+        frame.tiles.assign(area.x * area.y, blank);
+        frame.rowVersions.assign(area.y, 0);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Vector2u& GlyphTileBuffer::getArea() const
+{
+    return m_area;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const GlyphTileBuffer::Tile& GlyphTileBuffer::getTile(
+    const sf::Vector2u& coords) const
+{
+    return m_frames[m_back].tiles[(coords.y * m_area.x) + coords.x];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileBuffer::setTile(const sf::Vector2u& coords, const Tile& tile)
+{
+    getBackTile(coords) = tile;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileBuffer::setTileCharacter(const sf::Vector2u& coords,
+    wchar_t character, Tile::Type type, const sf::Vector2i& offset)
+{
+    Tile& tile = getBackTile(coords);
+
+    tile.character = character;
+    tile.type = type;
+    tile.offset = offset;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileBuffer::setTileForeground(const sf::Vector2u& coords,
+    const sf::Color& color)
+{
+    getBackTile(coords).foreground = color;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileBuffer::setTileBackground(const sf::Vector2u& coords,
+    const sf::Color& color)
+{
+    getBackTile(coords).background = color;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileBuffer::fillTiles(const sf::Vector2u& coords,
+    const sf::Vector2u& area, const Tile& tile)
+{
+    if (coords.x >= m_area.x || coords.y >= m_area.y) {
+        return;
+    }
+
+    sf::Vector2u end(std::min(coords.x + area.x, m_area.x),
+        std::min(coords.y + area.y, m_area.y));
+
+    for (sf::Uint32 y = coords.y; y < end.y; ++y) {
+        Tile* row = &getBackTile({0, y});
+        std::fill(row + coords.x, row + end.x, tile);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileBuffer::publish()
+{
+    Frame& back = m_frames[m_back];
+    ++m_version;
+
+    for (sf::Uint32 y = 0; y < m_area.y; ++y) {
+        if (m_dirtyRows[y]) {
+            back.rowVersions[y] = m_version;
+            m_dirtyRows[y] = 0;
+        }
+    }
+
+    // Releases the back buffer's tiles to the reader and takes back whichever
+    // Frame was latest, which the reader is done with.
+    sf::Uint32 previous = m_latest.exchange(m_back | Fresh,
+        std::memory_order_acq_rel);
+    m_published = m_back;
+    m_back = previous & IndexMask;
+
+    // The recycled Frame may be a publish or two behind; catch it up from
+    // the one just published, which the reader at most reads meanwhile.
+    Frame& next = m_frames[m_back];
+    const Frame& published = m_frames[m_published];
+
+    for (sf::Uint32 y = 0; y < m_area.y; ++y) {
+        if (next.rowVersions[y] != published.rowVersions[y]) {
+            std::copy(published.tiles.begin() + (y * m_area.x),
+                published.tiles.begin() + ((y + 1) * m_area.x),
+                next.tiles.begin() + (y * m_area.x));
+            next.rowVersions[y] = published.rowVersions[y];
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool GlyphTileBuffer::update(GlyphTileMap& tileMap)
+{
+    // Only the reader clears Fresh, so a fresh frame stays fresh until the
+    // exchange below takes it.
+    if (!(m_latest.load(std::memory_order_relaxed) & Fresh)) {
+        return false;
+    }
+
+    m_front = m_latest.exchange(m_front, std::memory_order_acq_rel)
+        & IndexMask;
+
+    const Frame& frame = m_frames[m_front];
+
+    for (sf::Uint32 y = 0; y < m_area.y; ++y) {
+        if (frame.rowVersions[y] != m_copiedVersions[y]) {
+            tileMap.setTileRow(y, &frame.tiles[y * m_area.x]);
+            m_copiedVersions[y] = frame.rowVersions[y];
+        }
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+GlyphTileBuffer::Tile& GlyphTileBuffer::getBackTile(const sf::Vector2u& coords)
+{
+    m_dirtyRows[coords.y] = 1;
+
+    return m_frames[m_back].tiles[(coords.y * m_area.x) + coords.x];
+}
@@ -0,0 +1,177 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       GlyphTileBuffer.h
+/// License:        MIT
+/// Description:    A triple-buffered grid of tiles, written by one thread and
+///                 published lock-free to a GlyphTileMap on another.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef GLYPH_TILE_BUFFER_H
+#define GLYPH_TILE_BUFFER_H
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <vector>
+
+#include <SFML/System.hpp>
+#include <SFML/Graphics.hpp>
+
+#include "GlyphTileMap.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// A GlyphTileBuffer lets a simulation thread build frames of tiles while the
+/// render thread draws. The writer sets tiles in a back buffer and calls
+/// publish(); the reader calls update() to copy the latest published frame
+/// into a GlyphTileMap. Buffers are exchanged with a single atomic swap, so
+/// neither side ever waits for the other, and the reader only ever sees whole
+/// published frames.
+///
+/// Exactly one thread may call the writer functions and exactly one (usually
+/// the one that draws the GlyphTileMap) may call update().
+///////////////////////////////////////////////////////////////////////////////
+class GlyphTileBuffer : sf::NonCopyable {
+public:
+
+    typedef GlyphTileMap::Tile Tile;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor
+    ///
+    /// All tiles start blank (L' ', Center, White foreground, Transparent
+    /// background).
+    ///
+    /// \param area     Width and height of the grid in # of tiles
+    ///////////////////////////////////////////////////////////////////////////
+    explicit GlyphTileBuffer(const sf::Vector2u& area);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a const reference to the area of the grid in tiles
+    ///
+    /// \return a const reference to the area of the grid in tiles
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Vector2u& getArea() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the Tile at a coords in the back buffer (writer only)
+    ///
+    /// \param coords   Coordinates in the grid to read
+    ///
+    /// \return a const reference to the Tile at coords
+    ///////////////////////////////////////////////////////////////////////////
+    const Tile& getTile(const sf::Vector2u& coords) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates a tile in the back buffer (writer only)
+    ///
+    /// \param coords   Coordinates in the grid to update
+    /// \param tile     GlyphTileMap::Tile to update the tile with
+    ///////////////////////////////////////////////////////////////////////////
+    void setTile(const sf::Vector2u& coords, const Tile& tile);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates the character of a tile in the back buffer (writer
+    /// only)
+    ///
+    /// \param coords       Coordinates in the grid to update
+    /// \param character    New character for the tile
+    /// \param type         Tile::Type of the new character (default Center)
+    /// \param offset       Exact spacing offset value of the new character
+    ///                     (default {0, 0})
+    ///////////////////////////////////////////////////////////////////////////
+    void setTileCharacter(const sf::Vector2u& coords, wchar_t character,
+        Tile::Type type = Tile::Center, const sf::Vector2i& offset = {0, 0});
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates the foreground color of a tile in the back buffer
+    /// (writer only)
+    ///
+    /// \param coords   Coordinates in the grid to update
+    /// \param color    New foreground color for the tile
+    ///////////////////////////////////////////////////////////////////////////
+    void setTileForeground(const sf::Vector2u& coords, const sf::Color& color);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates the background color of a tile in the back buffer
+    /// (writer only)
+    ///
+    /// \param coords   Coordinates in the grid to update
+    /// \param color    New background color for the tile
+    ///////////////////////////////////////////////////////////////////////////
+    void setTileBackground(const sf::Vector2u& coords, const sf::Color& color);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates a rectangle of the back buffer with data from a Tile
+    /// (writer only)
+    ///
+    /// The rectangle is clipped to the grid.
+    ///
+    /// \param coords   Coordinates of the top left tile of the rectangle
+    /// \param area     Width and height of the rectangle in # of tiles
+    /// \param tile     GlyphTileMap::Tile to fill the rectangle with
+    ///////////////////////////////////////////////////////////////////////////
+    void fillTiles(const sf::Vector2u& coords, const sf::Vector2u& area,
+        const Tile& tile);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Publishes the back buffer as the latest frame (writer only)
+    ///
+    /// The writer carries on with a new back buffer holding the same tiles.
+    /// Frames published before the reader picks them up are skipped, but
+    /// their changes are never lost.
+    ///////////////////////////////////////////////////////////////////////////
+    void publish();
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Copies the latest published frame into a GlyphTileMap (reader
+    /// only)
+    ///
+    /// Only rows that changed since the frame last copied are set, through
+    /// GlyphTileMap::setTileRow. Always update the same GlyphTileMap, whose
+    /// area must match the buffer's.
+    ///
+    /// \param tileMap  GlyphTileMap to copy the frame into
+    ///
+    /// \return true if a new frame was copied
+    ///////////////////////////////////////////////////////////////////////////
+    bool update(GlyphTileMap& tileMap);
+
+private:
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// Frame is one of the three buffers. Each row records the version of the
+    /// publish that last changed it, which tells the writer which rows a
+    /// recycled Frame is missing and the reader which rows to copy.
+    ///////////////////////////////////////////////////////////////////////////
+    struct Frame {
+        std::vector<Tile> tiles;
+        std::vector<sf::Uint64> rowVersions;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// m_latest holds the index of the latest Frame, with Fresh set until the
+    /// reader takes it.
+    ///////////////////////////////////////////////////////////////////////////
+    static const sf::Uint32 IndexMask = 3;
+    static const sf::Uint32 Fresh = 4;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Tile& getBackTile(const sf::Vector2u& coords);
+
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Vector2u m_area;
+    Frame m_frames[3];
+    std::atomic<sf::Uint32> m_latest;
+    sf::Uint32 m_back;
+    sf::Uint32 m_published;
+    sf::Uint64 m_version;
+    std::vector<sf::Uint8> m_dirtyRows;
+    sf::Uint32 m_front;
+    std::vector<sf::Uint64> m_copiedVersions;
+};
+
+#endif
@@ -12,6 +12,152 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "GlyphTileMap.h"
+#include "GlyphTileRecorder.h"
+#include "MappedFile.h"
+#include "PixelKernels.h"
+#include "QuadKernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <utility>
+
+///////////////////////////////////////////////////////////////////////////////
+/// FrameStats are only kept with GLYPH_TILE_MAP_STATS defined. Otherwise the
+/// counting statements expand to nothing, so counters must not be the only
+/// use of a value.
+///////////////////////////////////////////////////////////////////////////////
+#ifdef GLYPH_TILE_MAP_STATS
+#define GLYPH_TILE_MAP_COUNT(expression) (expression)
+#define GLYPH_TILE_MAP_TIME(total) StatsTimer statsTimer(total)
+#else
+#define GLYPH_TILE_MAP_COUNT(expression) ((void)0)
+#define GLYPH_TILE_MAP_TIME(total) static_cast<void>(sizeof(total))
+#endif
+
+namespace
+{
+
+#ifdef GLYPH_TILE_MAP_STATS
+///////////////////////////////////////////////////////////////////////////////
+/// Adds the lifetime of a scope to a FrameStats time.
+///////////////////////////////////////////////////////////////////////////////
+class StatsTimer {
+public:
+
+    explicit StatsTimer(sf::Time& total)
+        : m_total(total)
+        , m_clock()
+    {}
+
+    ~StatsTimer()
+    {
+        m_total += m_clock.getElapsedTime();
+    }
+
+private:
+
+    sf::Time& m_total;
+    sf::Clock m_clock;
+};
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+/// Scrolling rebases vertex positions once the scroll offset exceeds this many
+/// tiles, keeping them exactly representable as floats.
+///////////////////////////////////////////////////////////////////////////////
+const sf::Int32 MaxScroll = 1 << 16;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Parallel rebuilds hand out work in bands of this many tiles, rounded to
+/// whole rows.
+///////////////////////////////////////////////////////////////////////////////
+const sf::Uint32 RebuildBandSize = 8192;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Bulk updates gather up to this many tiles at a time for the quad kernels.
+///////////////////////////////////////////////////////////////////////////////
+const sf::Uint32 QuadRunSize = 64;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Characters that do not fit a PackedTile are stored as this instead.
+///////////////////////////////////////////////////////////////////////////////
+const sf::Uint32 ReplacementCharacter = 0xFFFD;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Every tile snapshot starts with these four bytes and a version number,
+/// which is bumped whenever the layout changes.
+///////////////////////////////////////////////////////////////////////////////
+const char SnapshotMagic[4] = {'G', 'T', 'M', 'S'};
+const sf::Uint32 SnapshotVersion = 1;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Codepoints of IBM code page 437, indexed by byte.
+///////////////////////////////////////////////////////////////////////////////
+const sf::Uint16 CP437Codepoints[256] = {
+    0x0000, 0x263A, 0x263B, 0x2665, 0x2666, 0x2663, 0x2660, 0x2022,
+    0x25D8, 0x25CB, 0x25D9, 0x2642, 0x2640, 0x266A, 0x266B, 0x263C,
+    0x25BA, 0x25C4, 0x2195, 0x203C, 0x00B6, 0x00A7, 0x25AC, 0x21A8,
+    0x2191, 0x2193, 0x2192, 0x2190, 0x221F, 0x2194, 0x25B2, 0x25BC,
+    0x0020, 0x0021, 0x0022, 0x0023, 0x0024, 0x0025, 0x0026, 0x0027,
+    0x0028, 0x0029, 0x002A, 0x002B, 0x002C, 0x002D, 0x002E, 0x002F,
+    0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037,
+    0x0038, 0x0039, 0x003A, 0x003B, 0x003C, 0x003D, 0x003E, 0x003F,
+    0x0040, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047,
+    0x0048, 0x0049, 0x004A, 0x004B, 0x004C, 0x004D, 0x004E, 0x004F,
+    0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057,
+    0x0058, 0x0059, 0x005A, 0x005B, 0x005C, 0x005D, 0x005E, 0x005F,
+    0x0060, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067,
+    0x0068, 0x0069, 0x006A, 0x006B, 0x006C, 0x006D, 0x006E, 0x006F,
+    0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077,
+    0x0078, 0x0079, 0x007A, 0x007B, 0x007C, 0x007D, 0x007E, 0x2302,
+    0x00C7, 0x00FC, 0x00E9, 0x00E2, 0x00E4, 0x00E0, 0x00E5, 0x00E7,
+    0x00EA, 0x00EB, 0x00E8, 0x00EF, 0x00EE, 0x00EC, 0x00C4, 0x00C5,
+    0x00C9, 0x00E6, 0x00C6, 0x00F4, 0x00F6, 0x00F2, 0x00FB, 0x00F9,
+    0x00FF, 0x00D6, 0x00DC, 0x00A2, 0x00A3, 0x00A5, 0x20A7, 0x0192,
+    0x00E1, 0x00ED, 0x00F3, 0x00FA, 0x00F1, 0x00D1, 0x00AA, 0x00BA,
+    0x00BF, 0x2310, 0x00AC, 0x00BD, 0x00BC, 0x00A1, 0x00AB, 0x00BB,
+    0x2591, 0x2592, 0x2593, 0x2502, 0x2524, 0x2561, 0x2562, 0x2556,
+    0x2555, 0x2563, 0x2551, 0x2557, 0x255D, 0x255C, 0x255B, 0x2510,
+    0x2514, 0x2534, 0x252C, 0x251C, 0x2500, 0x253C, 0x255E, 0x255F,
+    0x255A, 0x2554, 0x2569, 0x2566, 0x2560, 0x2550, 0x256C, 0x2567,
+    0x2568, 0x2564, 0x2565, 0x2559, 0x2558, 0x2552, 0x2553, 0x256B,
+    0x256A, 0x2518, 0x250C, 0x2588, 0x2584, 0x258C, 0x2590, 0x2580,
+    0x03B1, 0x00DF, 0x0393, 0x03C0, 0x03A3, 0x03C3, 0x00B5, 0x03C4,
+    0x03A6, 0x0398, 0x03A9, 0x03B4, 0x221E, 0x03C6, 0x03B5, 0x2229,
+    0x2261, 0x00B1, 0x2265, 0x2264, 0x2320, 0x2321, 0x00F7, 0x2248,
+    0x00B0, 0x2219, 0x00B7, 0x221A, 0x207F, 0x00B2, 0x25A0, 0x00A0,
+};
+
+///////////////////////////////////////////////////////////////////////////////
+GlyphTileMap::Tile blankTile()
+{
+    return GlyphTileMap::Tile(L' ', GlyphTileMap::Tile::Center,
+        sf::Color::White, sf::Color::Transparent);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// The number of tiles a glyph placed offset into its tile reaches past
+/// either side of it along one axis.
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 getTileOverhang(sf::Int32 offset, sf::Int32 size,
+    sf::Uint32 spacing)
+{
+    sf::Int32 tile = static_cast<sf::Int32>(spacing);
+    sf::Int32 overhang = std::max(-offset, offset + size - tile);
+
+    return overhang > 0 ? static_cast<sf::Uint32>((overhang + tile - 1)
+        / tile) : 0;
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Uint32 GlyphTileMap::NoQuad;
 
 ///////////////////////////////////////////////////////////////////////////////
 GlyphTileMap::Tile::Tile()
@@ -33,17 +179,211 @@ GlyphTileMap::Tile::Tile(wchar_t character, Type type,
     , background(background)
 {}
 
+///////////////////////////////////////////////////////////////////////////////
+GlyphTileMap::PackedTile::PackedTile()
+    : PackedTile(blankTile())
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+GlyphTileMap::PackedTile::PackedTile(const Tile& tile)
+    : foreground(tile.foreground)
+    , background(tile.background)
+{
+    static_assert(sizeof(PackedTile) == 13, "PackedTile must be 13 bytes");
+
+    setCharacter(tile.character, tile.type, tile.offset);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+GlyphTileMap::Tile GlyphTileMap::PackedTile::unpack() const
+{
+    return Tile(static_cast<wchar_t>(getCodepoint()), getType(), foreground,
+        background, getOffset());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 GlyphTileMap::PackedTile::getCodepoint() const
+{
+    return glyph[0] | (glyph[1] << 8) | ((glyph[2] & 0x1F) << 16);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+GlyphTileMap::Tile::Type GlyphTileMap::PackedTile::getType() const
+{
+    return static_cast<Tile::Type>((glyph[2] >> 5) & 0x3);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Vector2i GlyphTileMap::PackedTile::getOffset() const
+{
+    return {offset[0], offset[1]};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::PackedTile::setCharacter(wchar_t character,
+    Tile::Type type, const sf::Vector2i& offset)
+{
+    sf::Uint32 codepoint = static_cast<sf::Uint32>(character);
+
+    if (codepoint > MaxCodepoint) {
+        codepoint = ReplacementCharacter;
+    }
+
+    glyph[0] = static_cast<sf::Uint8>(codepoint);
+    glyph[1] = static_cast<sf::Uint8>(codepoint >> 8);
+    glyph[2] = static_cast<sf::Uint8>((codepoint >> 16) | (type << 5));
+    this->offset[0] = static_cast<sf::Int8>(std::max(-128, std::min(127,
+        offset.x)));
+    this->offset[1] = static_cast<sf::Int8>(std::max(-128, std::min(127,
+        offset.y)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <typename F>
+void GlyphTileMap::forEachRun(const sf::Vector2u& coords,
+    const sf::Vector2u& area, F function) const
+{
+    // A row of the rectangle is contiguous in storage unless it crosses the
+    // scrolled origin, in which case it wraps into a second run.
+    for (sf::Uint32 y = 0; y < area.y; ++y) {
+        sf::Vector2u cell = getCell({coords.x, coords.y + y});
+        sf::Uint32 row = cell.y * m_area.x;
+        sf::Uint32 count = std::min(area.x, m_area.x - cell.x);
+
+        function(row + cell.x, count, cell, sf::Vector2u(0, y));
+
+        if (count < area.x) {
+            function(row, area.x - count, sf::Vector2u(0, cell.y),
+                sf::Vector2u(count, y));
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+std::vector<sf::Uint32> GlyphTileMap::getCharset(Charset charset)
+{
+    switch (charset) {
+    case Ascii:
+        return getCharset({{0x20, 0x7E}});
+    case CP437:
+        return std::vector<sf::Uint32>(std::begin(CP437Codepoints),
+            std::end(CP437Codepoints));
+    case BoxDrawing:
+        return getCharset({{0x2500, 0x259F}});
+    }
+
+    return {};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+std::vector<sf::Uint32> GlyphTileMap::getCharset(
+    const std::vector<GlyphRange>& ranges)
+{
+    std::vector<sf::Uint32> codepoints;
+
+    for (const GlyphRange& range : ranges) {
+        for (sf::Uint32 codepoint = range.first;
+            codepoint <= range.last && codepoint <= MaxCodepoint;
+            ++codepoint) {
+            codepoints.push_back(codepoint);
+        }
+    }
+
+    return codepoints;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+GlyphTileMap::PrewarmReport GlyphTileMap::prewarmFont(sf::Font& font,
+    sf::Uint32 characterSize, const std::vector<sf::Uint32>& codepoints)
+{
+    PrewarmReport report = {0, 0, sf::Time::Zero};
+
+    // The atlas is the same sf::Texture for the life of the font; it is only
+    // recreated in place when it grows.
+    const sf::Texture& atlas = font.getTexture(characterSize);
+    sf::Vector2u atlasSize = atlas.getSize();
+    sf::Clock clock;
+
+    for (sf::Uint32 codepoint : codepoints) {
+        font.getGlyph(codepoint > MaxCodepoint ? ReplacementCharacter
+            : codepoint, characterSize, false);
+
+        if (atlas.getSize() != atlasSize) {
+            atlasSize = atlas.getSize();
+            ++report.atlasGrowths;
+        }
+    }
+
+    report.glyphCount = static_cast<sf::Uint32>(codepoints.size());
+    report.rasterizationTime = clock.getElapsedTime();
+
+    return report;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 GlyphTileMap::GlyphTileMap(sf::Font& font, const sf::Vector2u& area,
     const sf::Vector2u& spacing, sf::Uint32 characterSize)
-    : m_font(font)
-    , m_area(area)
-    , m_spacing(spacing)
-    , m_characterSize(characterSize)
-    , m_foreground(sf::Quads, area.x * area.y * 4)
-    , m_background(sf::Quads, area.x * area.y * 4)
+    : GlyphTileMap(std::make_shared<GlyphCache>(font, characterSize, spacing),
+        area)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+GlyphTileMap::GlyphTileMap(const BakedGlyphAtlas& atlas,
+    const sf::Vector2u& area, const sf::Vector2u& spacing)
+    : GlyphTileMap(std::make_shared<GlyphCache>(atlas, spacing), area)
 {}
 
+///////////////////////////////////////////////////////////////////////////////
+GlyphTileMap::GlyphTileMap(const std::shared_ptr<GlyphCache>& glyphCache,
+    const sf::Vector2u& area)
+    : m_glyphCache(glyphCache)
+    , m_area(area)
+    , m_spacing(glyphCache->getSpacing())
+    , m_origin(0, 0)
+    , m_scroll(0, 0)
+    , m_tiles(area.x * area.y)
+    , m_deferred(false)
+    , m_dirtyTiles(area.x * area.y, 0)
+    , m_dirtyRows(area.y, 0)
+    , m_dirty(false)
+    , m_foreground()
+    , m_quads(area.x * area.y, NoQuad)
+    , m_quadTiles()
+    , m_background(area.x * area.y, sf::Color::Transparent)
+    , m_light()
+    , m_backgroundTexture()
+    , m_backgroundDirtyTop(0)
+    , m_backgroundDirtyBottom(area.y)
+    , m_visibleBackgrounds(0)
+    , m_visibleBackgroundRows(area.y, 0)
+    , m_culledQuads(0)
+    , m_stats()
+    , m_cache()
+    , m_cacheDirtyTop(0)
+    , m_cacheDirtyBottom(area.y)
+    , m_overhang(0, 0)
+    , m_recorder(nullptr)
+{
+    // Backgrounds are one texel per tile, stretched over the grid by a
+    // single quad; the texture is created on the first draw.
+    writeBackgroundQuad(m_backgroundQuad, 0.f, 0.f,
+        static_cast<float>(area.x * m_spacing.x),
+        static_cast<float>(area.y * m_spacing.y));
+    m_backgroundQuad[0].texCoords = {0.f, 0.f};
+    m_backgroundQuad[1].texCoords = {static_cast<float>(area.x), 0.f};
+    m_backgroundQuad[2].texCoords = {static_cast<float>(area.x),
+        static_cast<float>(area.y)};
+    m_backgroundQuad[3].texCoords = {0.f, static_cast<float>(area.y)};
+
+    sf::Vector2f size(static_cast<float>(area.x * m_spacing.x),
+        static_cast<float>(area.y * m_spacing.y));
+    writeBackgroundQuad(m_cacheQuad, 0.f, 0.f, size.x, size.y);
+    m_cacheQuad[0].texCoords = {0.f, 0.f};
+    m_cacheQuad[1].texCoords = {size.x, 0.f};
+    m_cacheQuad[2].texCoords = size;
+    m_cacheQuad[3].texCoords = {0.f, size.y};
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 const sf::Vector2u& GlyphTileMap::getArea() const
 {
@@ -59,212 +399,1448 @@ const sf::Vector2u& GlyphTileMap::getSpacing() const
 ///////////////////////////////////////////////////////////////////////////////
 sf::Uint32 GlyphTileMap::getCharacterSize() const
 {
-    return m_characterSize;
+    return m_glyphCache->getCharacterSize();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+GlyphTileMap::Tile GlyphTileMap::getTile(const sf::Vector2u& coords) const
+{
+    return m_tiles[getIndex(coords)].unpack();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::setDeferred(bool deferred)
+{
+    if (!deferred) {
+        ensureVerticesUpdate();
+    }
+
+    m_deferred = deferred;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool GlyphTileMap::isDeferred() const
+{
+    return m_deferred;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::commit()
+{
+    ensureVerticesUpdate();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::setCached(bool cached)
+{
+    if (cached && !m_cache) {
+        m_cache.reset(new sf::RenderTexture());
+        m_cacheDirtyTop = 0;
+        m_cacheDirtyBottom = m_area.y;
+    } else if (!cached) {
+        m_cache.reset();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool GlyphTileMap::isCached() const
+{
+    return m_cache != nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::setRecorder(GlyphTileRecorder* recorder)
+{
+    static_assert(+DirtyCharacter == +GlyphTileRecorder::CharacterChannel
+        && +DirtyForeground == +GlyphTileRecorder::ForegroundChannel
+        && +DirtyBackground == +GlyphTileRecorder::BackgroundChannel,
+        "Dirty flags must match GlyphTileRecorder::Channels");
+
+    m_recorder = recorder;
+
+    if (m_recorder) {
+        m_recorder->markTiles({0, 0}, m_area, DirtyAll);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+GlyphTileRecorder* GlyphTileMap::getRecorder() const
+{
+    return m_recorder;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::rebuild(sf::Uint32 threadCount)
+{
+    if (m_tiles.empty()) {
+        return;
+    }
+
+    GLYPH_TILE_MAP_TIME(m_stats.updateTime);
+
+    // Load every glyph up front, since the workers only read the cache, and
+    // lay the quads of visible tiles out again in tile order so each band
+    // writes one contiguous range.
+    sf::Uint32 quadCount = 0;
+    m_quadTiles.clear();
+
+    for (sf::Uint32 index = 0; index < m_tiles.size(); ++index) {
+        const PackedTile& tile = m_tiles[index];
+
+        if (isVisible(getGlyph(tile.getCodepoint()), tile)) {
+            m_quads[index] = quadCount++;
+            m_quadTiles.push_back(index);
+        } else {
+            m_quads[index] = NoQuad;
+        }
+    }
+
+    m_foreground.resize(quadCount * 4);
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    sf::Uint32 bandRows = std::max(1u, RebuildBandSize / std::max(1u,
+        m_area.x));
+    sf::Uint32 bandCount = (m_area.y + bandRows - 1) / bandRows;
+    threadCount = std::min(threadCount, bandCount);
+
+    // Each worker keeps its own overhang, merged once they are done.
+    std::atomic<sf::Uint32> nextBand(0);
+    std::vector<sf::Vector2u> overhangs(threadCount, {0, 0});
+    auto work = [&](sf::Uint32 worker) {
+        for (sf::Uint32 band = nextBand++; band < bandCount;
+            band = nextBand++) {
+            updateRows(band * bandRows, std::min(m_area.y,
+                (band + 1) * bandRows), overhangs[worker]);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (sf::Uint32 i = 1; i < threadCount; ++i) {
+        workers.emplace_back(work, i);
+    }
+    work(0);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    for (const sf::Vector2u& overhang : overhangs) {
+        raiseOverhang(m_overhang, overhang);
+    }
+
+    std::fill(m_dirtyTiles.begin(), m_dirtyTiles.end(), 0);
+    std::fill(m_dirtyRows.begin(), m_dirtyRows.end(), 0);
+    m_dirty = false;
+    m_backgroundDirtyTop = 0;
+    m_backgroundDirtyBottom = m_area.y;
+
+    GLYPH_TILE_MAP_COUNT(m_stats.tilesUpdated += m_tiles.size());
+    GLYPH_TILE_MAP_COUNT(m_stats.verticesWritten += m_foreground.size());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 void GlyphTileMap::setTile(const sf::Vector2u& coords, const Tile& tile)
 {
-    updateTile(coords, tile);
+    m_tiles[getIndex(coords)] = tile;
+    invalidateTiles(coords, {1, 1}, DirtyAll);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::scroll(sf::Int32 dx, sf::Int32 dy)
+{
+    sf::Int32 width = static_cast<sf::Int32>(m_area.x);
+    sf::Int32 height = static_cast<sf::Int32>(m_area.y);
+
+    if (width == 0 || height == 0) {
+        return;
+    }
+
+    if (m_recorder) {
+        m_recorder->markScroll(dx, dy);
+    }
+
+    m_scroll.x += dx;
+    m_scroll.y += dy;
+    m_origin.x = static_cast<sf::Uint32>(((m_scroll.x % width) + width)
+        % width);
+    m_origin.y = static_cast<sf::Uint32>(((m_scroll.y % height) + height)
+        % height);
+
+    m_backgroundQuad[0].texCoords = sf::Vector2f(m_origin);
+    m_backgroundQuad[1].texCoords = sf::Vector2f(m_origin + sf::Vector2u(
+        m_area.x, 0));
+    m_backgroundQuad[2].texCoords = sf::Vector2f(m_origin + m_area);
+    m_backgroundQuad[3].texCoords = sf::Vector2f(m_origin + sf::Vector2u(0,
+        m_area.y));
+    invalidateCache(0, m_area.y);
+
+    if (std::abs(m_scroll.x) > MaxScroll || std::abs(m_scroll.y) > MaxScroll) {
+        // Every vertex position changes, so this is as good a time as any to
+        // rebuild; the newly exposed tiles are blanked below regardless.
+        m_scroll = sf::Vector2i(m_origin);
+        invalidateTiles({0, 0}, m_area, DirtyCharacter);
+    }
+
+    if (std::abs(dx) >= width || std::abs(dy) >= height) {
+        blankTiles({0, 0}, m_area);
+        return;
+    }
+
+    if (dx > 0) {
+        blankTiles({m_area.x - dx, 0},
+            {static_cast<sf::Uint32>(dx), m_area.y});
+    } else if (dx < 0) {
+        blankTiles({0, 0}, {static_cast<sf::Uint32>(-dx), m_area.y});
+    }
+
+    if (dy > 0) {
+        blankTiles({0, m_area.y - dy},
+            {m_area.x, static_cast<sf::Uint32>(dy)});
+    } else if (dy < 0) {
+        blankTiles({0, 0}, {m_area.x, static_cast<sf::Uint32>(-dy)});
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 void GlyphTileMap::setTileCharacter(const sf::Vector2u& coords,
     wchar_t character, Tile::Type type, const sf::Vector2i& offset)
 {
-    updateCharacter(coords, character, type, offset);
+    m_tiles[getIndex(coords)].setCharacter(character, type, offset);
+    invalidateTiles(coords, {1, 1}, DirtyCharacter);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 void GlyphTileMap::setTileForeground(const sf::Vector2u& coords,
     const sf::Color& color)
 {
-    updateForegroundColor(coords, color);
+    m_tiles[getIndex(coords)].foreground = color;
+    invalidateTiles(coords, {1, 1}, DirtyForeground);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 void GlyphTileMap::setTileBackground(const sf::Vector2u& coords,
     const sf::Color& color)
 {
-    updateBackgroundColor(coords, color);
+    m_tiles[getIndex(coords)].background = color;
+    invalidateTiles(coords, {1, 1}, DirtyBackground);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-void GlyphTileMap::draw(sf::RenderTarget& target, sf::RenderStates states)
-    const
+void GlyphTileMap::fillTiles(const sf::Vector2u& coords,
+    const sf::Vector2u& area, const Tile& tile)
 {
-    states.transform *= getTransform();
-    states.texture = &m_font.getTexture(m_characterSize);
-    target.draw(m_background, states);
-    target.draw(m_foreground, states);
+    sf::Vector2u clipped = clipArea(coords, area);
+
+    forEachRun(coords, clipped, [&](sf::Uint32 index, sf::Uint32 count,
+        const sf::Vector2u&, const sf::Vector2u&) {
+        std::fill(m_tiles.begin() + index, m_tiles.begin() + index + count,
+            PackedTile(tile));
+    });
+
+    invalidateTiles(coords, clipped, DirtyAll);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-sf::Uint32 GlyphTileMap::getIndex(const sf::Vector2u& coords) const
+void GlyphTileMap::setTiles(const sf::Vector2u& coords,
+    const sf::Vector2u& area, const Tile* tiles)
+{
+    sf::Vector2u clipped = clipArea(coords, area);
+
+    forEachRun(coords, clipped, [&](sf::Uint32 index, sf::Uint32 count,
+        const sf::Vector2u&, const sf::Vector2u& offset) {
+        const Tile* source = tiles + (offset.y * area.x) + offset.x;
+        std::copy(source, source + count, m_tiles.begin() + index);
+    });
+
+    invalidateTiles(coords, clipped, DirtyAll);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::setTileRow(sf::Uint32 row, const Tile* tiles)
 {
-    return (coords.y * m_area.x) + coords.x;
+    setTiles({0, row}, {m_area.x, 1}, tiles);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-void GlyphTileMap::updateTile(const sf::Vector2u& coords, const Tile& tile)
+void GlyphTileMap::fillTileCharacter(const sf::Vector2u& coords,
+    const sf::Vector2u& area, wchar_t character, Tile::Type type,
+    const sf::Vector2i& offset)
 {
-    const sf::Glyph& glyph = m_font.getGlyph(tile.character, m_characterSize,
-        false);
+    sf::Vector2u clipped = clipArea(coords, area);
 
-    sf::Vector2i adjustedOffset = {0, 0};
+    forEachRun(coords, clipped, [&](sf::Uint32 index, sf::Uint32 count,
+        const sf::Vector2u&, const sf::Vector2u&) {
+        PackedTile packed;
+        packed.setCharacter(character, type, offset);
 
-    switch (tile.type) {
-    case Tile::Text:
-        {
-        adjustedOffset.x = glyph.bounds.left;
-        adjustedOffset.y = m_spacing.y + glyph.bounds.top;
+        for (PackedTile* tile = &m_tiles[index]; count > 0; --count, ++tile) {
+            std::copy(packed.glyph, packed.glyph + 3, tile->glyph);
+            std::copy(packed.offset, packed.offset + 2, tile->offset);
         }
-        break;
-    case Tile::Exact:
-        adjustedOffset.x = (m_spacing.x - glyph.textureRect.width) / 2;
-        adjustedOffset.y = (m_spacing.y - glyph.textureRect.height) / 2;
-        adjustedOffset.x += tile.offset.x;
-        adjustedOffset.y += tile.offset.y;
-        break;
-    case Tile::Floor:
-        adjustedOffset.x = (m_spacing.x - glyph.textureRect.width) / 2;
-        adjustedOffset.y = m_spacing.y - glyph.textureRect.height;
-        break;
-    case Tile::Center:
-        adjustedOffset.x = (m_spacing.x - glyph.textureRect.width) / 2;
-        adjustedOffset.y = (m_spacing.y - glyph.textureRect.height) / 2;
-        break;
-    }
+    });
 
-    updateForegroundPosition(coords, glyph.textureRect, adjustedOffset);
-    updateForegroundColor(coords, tile.foreground);
-    updateBackgroundPosition(coords);
-    updateBackgroundColor(coords, tile.background);
+    invalidateTiles(coords, clipped, DirtyCharacter);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-void GlyphTileMap::updateCharacter(const sf::Vector2u& coords,
-        wchar_t character, Tile::Type type, const sf::Vector2i& offset)
+void GlyphTileMap::fillTileForeground(const sf::Vector2u& coords,
+    const sf::Vector2u& area, const sf::Color& color)
 {
-    const sf::Glyph& glyph = m_font.getGlyph(character, m_characterSize,
-        false);
+    sf::Vector2u clipped = clipArea(coords, area);
 
-    sf::Vector2i adjustedOffset = {0, 0};
-
-    switch (type) {
-    case Tile::Text:
-        {
-        adjustedOffset.x = glyph.bounds.left;
-        adjustedOffset.y = m_spacing.y + glyph.bounds.top;
+    forEachRun(coords, clipped, [&](sf::Uint32 index, sf::Uint32 count,
+        const sf::Vector2u&, const sf::Vector2u&) {
+        for (PackedTile* tile = &m_tiles[index]; count > 0; --count, ++tile) {
+            tile->foreground = color;
         }
-        break;
-    case Tile::Exact:
-        adjustedOffset.x = (m_spacing.x - glyph.textureRect.width) / 2;
-        adjustedOffset.y = (m_spacing.y - glyph.textureRect.height) / 2;
-        adjustedOffset.x += offset.x;
-        adjustedOffset.y += offset.y;
-        break;
-    case Tile::Floor:
-        adjustedOffset.x = (m_spacing.x - glyph.textureRect.width) / 2;
-        adjustedOffset.y = m_spacing.y - glyph.textureRect.height;
-        break;
-    case Tile::Center:
-        adjustedOffset.x = (m_spacing.x - glyph.textureRect.width) / 2;
-        adjustedOffset.y = (m_spacing.y - glyph.textureRect.height) / 2;
-        break;
-    }
-
-    updateForegroundPosition(coords, glyph.textureRect, adjustedOffset);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-void GlyphTileMap::updateForegroundPosition(const sf::Vector2u& coords,
-    const sf::IntRect& textureRect, const sf::Vector2i& offset)
-{
-    sf::Uint32 index = getIndex(coords) * 4;
-
-    m_foreground[index].position = {
-        static_cast<float>((coords.x * m_spacing.x) + offset.x),
-        static_cast<float>((coords.y * m_spacing.y) + offset.y)
-        };
-    m_foreground[index + 1].position = {
-        static_cast<float>((coords.x * m_spacing.x) + textureRect.width
-            + offset.x),
-        static_cast<float>((coords.y * m_spacing.y) + offset.y)
-        };
-    m_foreground[index + 2].position = {
-        static_cast<float>((coords.x * m_spacing.x) + textureRect.width
-            + offset.x),
-        static_cast<float>((coords.y * m_spacing.y) + textureRect.height
-            + offset.y)
-        };
-    m_foreground[index + 3].position = {
-        static_cast<float>((coords.x * m_spacing.x) + offset.x),
-        static_cast<float>((coords.y * m_spacing.y) + textureRect.height
-            + offset.y)
-        };
-    m_foreground[index].texCoords = {
-        static_cast<float>(textureRect.left),
-        static_cast<float>(textureRect.top)
-        };
-    m_foreground[index + 1].texCoords = {
-        static_cast<float>(textureRect.left + textureRect.width),
-        static_cast<float>(textureRect.top)
-        };
-    m_foreground[index + 2].texCoords = {
-        static_cast<float>(textureRect.left + textureRect.width),
-        static_cast<float>(textureRect.top + textureRect.height)
-        };
-    m_foreground[index + 3].texCoords = {
-        static_cast<float>(textureRect.left),
-        static_cast<float>(textureRect.top + textureRect.height)
-        };
-}
-
-///////////////////////////////////////////////////////////////////////////////
-void GlyphTileMap::updateForegroundColor(const sf::Vector2u& coords,
-    const sf::Color& color)
-{
-    sf::Uint32 index = getIndex(coords) * 4;
+    });
 
-    m_foreground[index].color = color;
-    m_foreground[index + 1].color = color;
-    m_foreground[index + 2].color = color;
-    m_foreground[index + 3].color = color;
+    invalidateTiles(coords, clipped, DirtyForeground);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-void GlyphTileMap::updateBackgroundPosition(const sf::Vector2u& coords)
+void GlyphTileMap::fillTileBackground(const sf::Vector2u& coords,
+    const sf::Vector2u& area, const sf::Color& color)
 {
-    sf::Uint32 index = getIndex(coords) * 4;
+    sf::Vector2u clipped = clipArea(coords, area);
+
+    forEachRun(coords, clipped, [&](sf::Uint32 index, sf::Uint32 count,
+        const sf::Vector2u&, const sf::Vector2u&) {
+        for (PackedTile* tile = &m_tiles[index]; count > 0; --count, ++tile) {
+            tile->background = color;
+        }
+    });
 
-    m_background[index].position = {
-        static_cast<float>(coords.x * m_spacing.x),
-        static_cast<float>(coords.y * m_spacing.y)
-        };
-    m_background[index + 1].position = {
-        static_cast<float>((coords.x * m_spacing.x) + m_spacing.x),
-        static_cast<float>(coords.y * m_spacing.y)
-        };
-    m_background[index + 2].position = {
-        static_cast<float>((coords.x * m_spacing.x) + m_spacing.x),
-        static_cast<float>((coords.y * m_spacing.y) + m_spacing.y)
-        };
-    m_background[index + 3].position = {
-        static_cast<float>(coords.x * m_spacing.x),
-        static_cast<float>((coords.y * m_spacing.y) + m_spacing.y)
-        };
+    invalidateTiles(coords, clipped, DirtyBackground);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-void GlyphTileMap::updateBackgroundColor(const sf::Vector2u& coords,
-    const sf::Color& color)
+void GlyphTileMap::blit(const GlyphTileMap& source,
+    const sf::Vector2u& sourceCoords, const sf::Vector2u& area,
+    const sf::Vector2u& coords, const sf::Uint8* mask)
 {
-    sf::Uint32 index = getIndex(coords) * 4;
+    sf::Vector2u clipped = source.clipArea(sourceCoords,
+        clipArea(coords, area));
 
-    m_background[index].color = color;
-    m_background[index + 1].color = color;
-    m_background[index + 2].color = color;
-    m_background[index + 3].color = color;
-}
+    if (clipped.x == 0 || clipped.y == 0
+        || (&source == this && sourceCoords == coords)) {
+        return;
+    }
+
+    // Quads can only be reused if the source's are up to date and its glyphs
+    // have the same texture coordinates and offsets as this map's would.
+    bool reuseQuads = m_glyphCache->hasSameGlyphs(*source.m_glyphCache);
+
+    // Copied quads are moved by whole tiles, so they reach no further past
+    // their tiles than they did in the source.
+    if (reuseQuads) {
+        source.ensureVerticesUpdate();
+        raiseOverhang(m_overhang, source.m_overhang);
+    }
+
+    // Within one map, rows and columns are copied in the order that reads
+    // every tile before it is overwritten, as memmove does.
+    bool reverseRows = &source == this && coords.y > sourceCoords.y;
+    bool reverseColumns = &source == this && coords.x > sourceCoords.x;
+
+    // A tile's quad is at its scrolled coordinates, so every quad copied
+    // moves by the same amount.
+    sf::Vector2f delta = getCellPosition(getCell(coords))
+        - source.getCellPosition(source.getCell(sourceCoords));
+    sf::Uint32 checkedCodepoint = MaxCodepoint + 1;
+    sf::Uint32 top = m_area.y;
+    sf::Uint32 bottom = 0;
+
+    {
+        GLYPH_TILE_MAP_TIME(m_stats.updateTime);
+
+        for (sf::Uint32 i = 0; i < clipped.y; ++i) {
+            sf::Uint32 y = reverseRows ? clipped.y - 1 - i : i;
+            sf::Vector2u sourceCell = source.getCell({sourceCoords.x,
+                sourceCoords.y + y});
+            sf::Vector2u cell = getCell({coords.x, coords.y + y});
+            const sf::Uint8* maskRow = mask ? mask + (y * area.x) : nullptr;
+
+            top = std::min(top, cell.y);
+            bottom = std::max(bottom, cell.y + 1);
+
+            for (sf::Uint32 j = 0; j < clipped.x; ++j) {
+                sf::Uint32 x = reverseColumns ? clipped.x - 1 - j : j;
 
+                if (maskRow && !maskRow[x]) {
+                    continue;
+                }
+
+                sf::Uint32 sourceX = sourceCell.x + x;
+                sf::Uint32 cellX = cell.x + x;
+
+                if (sourceX >= source.m_area.x) {
+                    sourceX -= source.m_area.x;
+                }
+
+                if (cellX >= m_area.x) {
+                    cellX -= m_area.x;
+                }
+
+                sf::Uint32 sourceIndex = (sourceCell.y * source.m_area.x)
+                    + sourceX;
+                sf::Uint32 index = (cell.y * m_area.x) + cellX;
+                const PackedTile& tile = m_tiles[index]
+                    = source.m_tiles[sourceIndex];
+
+                if (!reuseQuads) {
+                    continue;
+                }
+
+                m_background[index] = getLitColor(tile.background, index);
+
+                if (source.m_quads[sourceIndex] == NoQuad) {
+                    releaseQuad(index);
+                    continue;
+                }
+
+                // The glyph is already placed, but this map's cache must
+                // still hold every glyph it draws. Prefabs repeat glyphs in
+                // runs, so a run is only looked up once.
+                if (tile.getCodepoint() != checkedCodepoint) {
+                    checkedCodepoint = tile.getCodepoint();
+
+                    if (!m_glyphCache->find(checkedCodepoint)) {
+                        getGlyph(checkedCodepoint);
+                    }
+                }
+
+                sf::Vertex* quad = &m_foreground[acquireQuad(index) * 4];
+                const sf::Vertex* sourceQuad = &source.m_foreground[
+                    source.m_quads[sourceIndex] * 4];
+                sf::Color color = getLitColor(tile.foreground, index);
+
+                for (sf::Uint32 v = 0; v < 4; ++v) {
+                    quad[v].position = sourceQuad[v].position + delta;
+                    quad[v].texCoords = sourceQuad[v].texCoords;
+                    quad[v].color = color;
+                }
+
+                GLYPH_TILE_MAP_COUNT(m_stats.verticesWritten += 4);
+            }
+        }
+    }
+
+    if (!reuseQuads) {
+        invalidateTiles(coords, clipped, DirtyAll);
+        return;
+    }
+
+    m_backgroundDirtyTop = std::min(m_backgroundDirtyTop, top);
+    m_backgroundDirtyBottom = std::max(m_backgroundDirtyBottom, bottom);
+    invalidateCache(coords.y, coords.y + clipped.y);
+
+    if (m_recorder) {
+        m_recorder->markTiles(coords, clipped, DirtyAll);
+    }
+
+    GLYPH_TILE_MAP_COUNT(m_stats.tilesUpdated += clipped.x * clipped.y);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::setLightMap(const sf::Color* tints)
+{
+    m_light.resize(m_tiles.size());
+
+    forEachRun({0, 0}, m_area, [&](sf::Uint32 index, sf::Uint32 count,
+        const sf::Vector2u&, const sf::Vector2u& offset) {
+        const sf::Color* source = tints + (offset.y * m_area.x) + offset.x;
+
+        for (sf::Uint32 i = 0; i < count; ++i) {
+            m_light[index + i] = sf::Color(source[i].r, source[i].g,
+                source[i].b);
+        }
+    });
+
+    applyLightMap();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::setLightMap(const sf::Uint8* levels)
+{
+    m_light.resize(m_tiles.size());
+
+    forEachRun({0, 0}, m_area, [&](sf::Uint32 index, sf::Uint32 count,
+        const sf::Vector2u&, const sf::Vector2u& offset) {
+        const sf::Uint8* source = levels + (offset.y * m_area.x) + offset.x;
+
+        for (sf::Uint32 i = 0; i < count; ++i) {
+            m_light[index + i] = sf::Color(source[i], source[i], source[i]);
+        }
+    });
+
+    applyLightMap();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::clearLightMap()
+{
+    if (!m_light.empty()) {
+        m_light.clear();
+        m_light.shrink_to_fit();
+        applyLightMap();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool GlyphTileMap::saveToFile(const std::string& filename) const
+{
+    SnapshotHeader header = {{SnapshotMagic[0], SnapshotMagic[1],
+        SnapshotMagic[2], SnapshotMagic[3]}, SnapshotVersion, m_area.x,
+        m_area.y, m_spacing.x, m_spacing.y, getCharacterSize()};
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) {
+        sf::err() << "Failed to open \"" << filename << "\" for writing"
+            << std::endl;
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Rows are written in map order, which only differs from storage order
+    // once the map has been scrolled.
+    forEachRun({0, 0}, m_area, [&](sf::Uint32 index, sf::Uint32 count,
+        const sf::Vector2u&, const sf::Vector2u&) {
+        file.write(reinterpret_cast<const char*>(&m_tiles[index]),
+            static_cast<std::streamsize>(count) * sizeof(PackedTile));
+    });
+
+    if (!file) {
+        sf::err() << "Failed to write tile snapshot \"" << filename << "\""
+            << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool GlyphTileMap::loadFromFile(const std::string& filename)
+{
+    MappedFile file;
+
+    if (!file.open(filename)) {
+        sf::err() << "Failed to map tile snapshot \"" << filename << "\""
+            << std::endl;
+        return false;
+    }
+
+    SnapshotHeader header;
+    std::size_t tilesSize = 0;
+
+    if (file.getSize() >= sizeof(SnapshotHeader)) {
+        std::memcpy(&header, file.getData(), sizeof(SnapshotHeader));
+        tilesSize = static_cast<std::size_t>(header.width) * header.height
+            * sizeof(PackedTile);
+    }
+
+    if (file.getSize() < sizeof(SnapshotHeader)
+        || std::memcmp(header.magic, SnapshotMagic, sizeof(SnapshotMagic))
+        != 0
+        || header.version != SnapshotVersion
+        || file.getSize() != sizeof(SnapshotHeader) + tilesSize) {
+        sf::err() << "Failed to load tile snapshot \"" << filename
+            << "\" (not a tile snapshot, or saved by another version)"
+            << std::endl;
+        return false;
+    }
+
+    if (header.width != m_area.x || header.height != m_area.y
+        || header.spacingX != m_spacing.x || header.spacingY != m_spacing.y
+        || header.characterSize != getCharacterSize()) {
+        sf::err() << "Failed to load tile snapshot \"" << filename
+            << "\" (saved from a map with a different area, spacing or "
+            << "character size)" << std::endl;
+        return false;
+    }
+
+    const PackedTile* tiles = reinterpret_cast<const PackedTile*>(
+        file.getData() + sizeof(SnapshotHeader));
+
+    forEachRun({0, 0}, m_area, [&](sf::Uint32 index, sf::Uint32 count,
+        const sf::Vector2u&, const sf::Vector2u& offset) {
+        std::memcpy(&m_tiles[index], tiles + (offset.y * m_area.x) + offset.x,
+            count * sizeof(PackedTile));
+    });
+
+    // A PackedTile has room for codepoints past U+10FFFF, which a damaged
+    // file could hold.
+    for (PackedTile& tile : m_tiles) {
+        if (tile.getCodepoint() > MaxCodepoint) {
+            tile.setCharacter(static_cast<wchar_t>(ReplacementCharacter),
+                tile.getType(), tile.getOffset());
+        }
+    }
+
+    rebuild();
+    invalidateCache(0, m_area.y);
+
+    if (m_recorder) {
+        m_recorder->markTiles({0, 0}, m_area, DirtyAll);
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::clearGlyphCache()
+{
+    m_glyphCache->clear();
+
+    // Every quad still holds texture coordinates from before the clear, so
+    // all of them are placed again from freshly loaded glyphs.
+    for (sf::Uint32 y = 0, index = 0; y < m_area.y; ++y) {
+        for (sf::Uint32 x = 0; x < m_area.x; ++x, ++index) {
+            m_dirtyTiles[index] |= DirtyCharacter;
+        }
+        m_dirtyRows[y] = 1;
+    }
+    m_dirty = true;
+
+    invalidateCache(0, m_area.y);
+
+    if (!m_deferred) {
+        ensureVerticesUpdate();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint64 GlyphTileMap::getGlyphCacheHits() const
+{
+    return m_glyphCache->getHits();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint64 GlyphTileMap::getGlyphCacheMisses() const
+{
+    return m_glyphCache->getMisses();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 GlyphTileMap::getCulledQuadCount() const
+{
+    return m_culledQuads;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+GlyphTileMap::FrameStats GlyphTileMap::getFrameStats() const
+{
+    FrameStats stats = m_stats;
+
+#ifdef GLYPH_TILE_MAP_STATS
+    stats.atlasSize = m_glyphCache->getTexture().getSize();
+#endif
+
+    return stats;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::resetFrameStats()
+{
+#ifdef GLYPH_TILE_MAP_STATS
+    m_stats = FrameStats();
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+GlyphTileMap::PrewarmReport GlyphTileMap::prewarmGlyphs(
+    const std::vector<sf::Uint32>& codepoints)
+{
+    PrewarmReport report = {0, 0, sf::Time::Zero};
+
+    if (m_glyphCache->getFont()) {
+        report = prewarmFont(*m_glyphCache->getFont(),
+            m_glyphCache->getCharacterSize(), codepoints);
+    }
+
+    for (sf::Uint32 codepoint : codepoints) {
+        getGlyph(codepoint);
+    }
+
+    return report;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::render(sf::Uint8* pixels, const sf::Color& clearColor)
+    const
+{
+    ensureVerticesUpdate();
+
+    int width = static_cast<int>(m_area.x * m_spacing.x);
+    int height = static_cast<int>(m_area.y * m_spacing.y);
+    std::size_t pitch = static_cast<std::size_t>(width) * 4;
+
+    // Each background covers its whole tile, so it is blended over the clear
+    // color once and filled in. Every pixel row of a row of tiles is the
+    // same, so only the first is filled and the rest are copies.
+    for (sf::Uint32 y = 0; y < m_area.y; ++y) {
+        sf::Uint8* row = pixels + (y * m_spacing.y * pitch);
+
+        for (sf::Uint32 x = 0; x < m_area.x; ++x) {
+            fillPixels(row + (x * m_spacing.x * 4), m_spacing.x,
+                blendColor(clearColor, m_background[getIndex({x, y})]));
+        }
+
+        for (sf::Uint32 i = 1; i < m_spacing.y; ++i) {
+            std::memcpy(row + (i * pitch), row, pitch);
+        }
+    }
+
+    if (m_foreground.empty()) {
+        return;
+    }
+
+    // Glyphs are blended in the order draw() submits their quads, clipped to
+    // the buffer, from their unwrapped, scrolled positions.
+    const sf::Image& atlas = m_glyphCache->getAtlasImage();
+    const sf::Uint8* texels = atlas.getPixelsPtr();
+    std::size_t texelPitch = static_cast<std::size_t>(atlas.getSize().x) * 4;
+    sf::Vector2i scroll(m_scroll.x * static_cast<sf::Int32>(m_spacing.x),
+        m_scroll.y * static_cast<sf::Int32>(m_spacing.y));
+
+    for (std::size_t i = 0; i < m_foreground.size(); i += 4) {
+        const sf::Vertex* quad = &m_foreground[i];
+        int left = static_cast<int>(quad[0].position.x) - scroll.x;
+        int top = static_cast<int>(quad[0].position.y) - scroll.y;
+        int right = static_cast<int>(quad[2].position.x) - scroll.x;
+        int bottom = static_cast<int>(quad[2].position.y) - scroll.y;
+        int u = static_cast<int>(quad[0].texCoords.x);
+        int v = static_cast<int>(quad[0].texCoords.y);
+
+        if (left < 0) {
+            u -= left;
+            left = 0;
+        }
+
+        if (top < 0) {
+            v -= top;
+            top = 0;
+        }
+
+        right = std::min(right, width);
+        bottom = std::min(bottom, height);
+
+        if (left >= right || top >= bottom) {
+            continue;
+        }
+
+        blendTexels(pixels + (top * pitch) + (left * 4), pitch,
+            texels + (v * texelPitch) + (u * 4), texelPitch,
+            static_cast<std::size_t>(right - left),
+            static_cast<std::size_t>(bottom - top), quad[0].color);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::render(sf::Image& image, const sf::Color& clearColor)
+    const
+{
+    std::vector<sf::Uint8> pixels(m_area.x * m_spacing.x * m_area.y
+        * m_spacing.y * 4);
+
+    render(pixels.data(), clearColor);
+    image.create(m_area.x * m_spacing.x, m_area.y * m_spacing.y,
+        pixels.data());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::draw(sf::RenderTarget& target, sf::RenderStates states)
+    const
+{
+    ensureVerticesUpdate();
+    ensureBackgroundUpdate();
+
+    states.transform *= getTransform();
+
+    // Without a render texture to cache into, the map is drawn as usual.
+    if (m_cache && ensureCacheUpdate()) {
+        GLYPH_TILE_MAP_TIME(m_stats.drawTime);
+
+        // The cache holds premultiplied colors.
+        states.texture = &m_cache->getTexture();
+        states.blendMode = sf::BlendMode(sf::BlendMode::One,
+            sf::BlendMode::OneMinusSrcAlpha);
+        target.draw(m_cacheQuad, 4, sf::Quads, states);
+        GLYPH_TILE_MAP_COUNT(m_stats.verticesSubmitted += 4);
+        GLYPH_TILE_MAP_COUNT(++m_stats.drawCalls);
+        return;
+    }
+
+    GLYPH_TILE_MAP_TIME(m_stats.drawTime);
+
+    drawLayers(target, states);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::drawBackground(sf::RenderTarget& target,
+    sf::RenderStates states) const
+{
+    ensureVerticesUpdate();
+    ensureBackgroundUpdate();
+
+    states.transform *= getTransform();
+
+    GLYPH_TILE_MAP_TIME(m_stats.drawTime);
+
+    drawBackgroundLayer(target, states);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::drawForeground(sf::RenderTarget& target,
+    sf::RenderStates states) const
+{
+    ensureVerticesUpdate();
+
+    states.transform *= getTransform();
+
+    GLYPH_TILE_MAP_TIME(m_stats.drawTime);
+
+    drawForegroundLayer(target, states);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Vector2u& GlyphTileMap::getGlyphOverhang() const
+{
+    return m_overhang;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::drawLayers(sf::RenderTarget& target,
+    sf::RenderStates states) const
+{
+    drawBackgroundLayer(target, states);
+    drawForegroundLayer(target, states);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::drawBackgroundLayer(sf::RenderTarget& target,
+    sf::RenderStates states) const
+{
+    if (m_visibleBackgrounds > 0) {
+        states.texture = &m_backgroundTexture;
+        target.draw(m_backgroundQuad, 4, sf::Quads, states);
+        GLYPH_TILE_MAP_COUNT(m_stats.verticesSubmitted += 4);
+        GLYPH_TILE_MAP_COUNT(++m_stats.drawCalls);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::drawForegroundLayer(sf::RenderTarget& target,
+    sf::RenderStates states) const
+{
+    m_culledQuads = static_cast<sf::Uint32>(m_tiles.size()
+        - m_quadTiles.size()) + (m_visibleBackgrounds > 0 ? 0 : 1);
+
+    // Foreground vertices live at their unwrapped, scrolled positions.
+    states.transform.translate(
+        -static_cast<float>(m_scroll.x * static_cast<sf::Int32>(m_spacing.x)),
+        -static_cast<float>(m_scroll.y * static_cast<sf::Int32>(m_spacing.y)));
+    states.texture = &m_glyphCache->getTexture();
+
+    if (!m_foreground.empty()) {
+        target.draw(m_foreground.data(), m_foreground.size(), sf::Quads,
+            states);
+        GLYPH_TILE_MAP_COUNT(m_stats.verticesSubmitted += m_foreground.size());
+        GLYPH_TILE_MAP_COUNT(++m_stats.drawCalls);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool GlyphTileMap::ensureCacheUpdate() const
+{
+    sf::Vector2u size(m_area.x * m_spacing.x, m_area.y * m_spacing.y);
+
+    if (m_cache->getSize() != size) {
+        if (!m_cache->create(size.x, size.y)) {
+            return false;
+        }
+        m_cacheDirtyTop = 0;
+        m_cacheDirtyBottom = m_area.y;
+    }
+
+    if (m_cacheDirtyTop >= m_cacheDirtyBottom) {
+        return true;
+    }
+
+    GLYPH_TILE_MAP_TIME(m_stats.updateTime);
+
+    // Glyphs may reach into the rows around their own, so the band is
+    // widened by the furthest any glyph written so far does. It never
+    // shrinks, since glyphs already in the cache may have reached further.
+    sf::Uint32 top = m_cacheDirtyTop > m_overhang.y
+        ? m_cacheDirtyTop - m_overhang.y : 0;
+    sf::Uint32 bottom = std::min(m_area.y,
+        m_cacheDirtyBottom + m_overhang.y);
+    sf::FloatRect band(0.f, static_cast<float>(top * m_spacing.y),
+        static_cast<float>(size.x),
+        static_cast<float>((bottom - top) * m_spacing.y));
+
+    // Limit drawing to the band by viewing only it, through a viewport
+    // covering the same pixels.
+    sf::View view(band);
+    view.setViewport(sf::FloatRect(0.f, band.top / size.y, 1.f,
+        band.height / size.y));
+    m_cache->setView(view);
+
+    // clear() would wipe the whole texture, so the band is overwritten with
+    // transparent pixels instead.
+    sf::Vertex blank[4];
+    writeBackgroundQuad(blank, band.left, band.top, band.width, band.height);
+    writeQuadColor(blank, sf::Color::Transparent);
+    m_cache->draw(blank, 4, sf::Quads, sf::BlendNone);
+
+    // Blending alpha as One, OneMinusSrcAlpha keeps the colors premultiplied
+    // over the transparent pixels.
+    sf::RenderStates states(sf::BlendMode(sf::BlendMode::SrcAlpha,
+        sf::BlendMode::OneMinusSrcAlpha, sf::BlendMode::Add,
+        sf::BlendMode::One, sf::BlendMode::OneMinusSrcAlpha,
+        sf::BlendMode::Add));
+    drawLayers(*m_cache, states);
+    m_cache->display();
+
+    m_cacheDirtyTop = m_area.y;
+    m_cacheDirtyBottom = 0;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::invalidateCache(sf::Uint32 top, sf::Uint32 bottom)
+{
+    m_cacheDirtyTop = std::min(m_cacheDirtyTop, top);
+    m_cacheDirtyBottom = std::max(m_cacheDirtyBottom, bottom);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 GlyphTileMap::getIndex(const sf::Vector2u& coords) const
+{
+    sf::Vector2u cell = getCell(coords);
+
+    return (cell.y * m_area.x) + cell.x;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Vector2u GlyphTileMap::getCell(const sf::Vector2u& coords) const
+{
+    sf::Vector2u cell = coords + m_origin;
+
+    if (cell.x >= m_area.x) {
+        cell.x -= m_area.x;
+    }
+
+    if (cell.y >= m_area.y) {
+        cell.y -= m_area.y;
+    }
+
+    return cell;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Vector2f GlyphTileMap::getCellPosition(const sf::Vector2u& cell) const
+{
+    // The scrolled position of a cell is the one congruent to it modulo the
+    // area that lies within [m_scroll, m_scroll + m_area).
+    sf::Int32 x = m_scroll.x - static_cast<sf::Int32>(m_origin.x)
+        + static_cast<sf::Int32>(cell.x < m_origin.x ? cell.x + m_area.x
+        : cell.x);
+    sf::Int32 y = m_scroll.y - static_cast<sf::Int32>(m_origin.y)
+        + static_cast<sf::Int32>(cell.y < m_origin.y ? cell.y + m_area.y
+        : cell.y);
+
+    return {static_cast<float>(x * static_cast<sf::Int32>(m_spacing.x)),
+        static_cast<float>(y * static_cast<sf::Int32>(m_spacing.y))};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Vector2i GlyphTileMap::getAdjustedOffset(const GlyphCache::Glyph& glyph,
+    Tile::Type type, const sf::Vector2i& offset)
+{
+    switch (type) {
+    case Tile::Text:
+        return glyph.textOffset;
+    case Tile::Exact:
+        return glyph.centerOffset + offset;
+    case Tile::Floor:
+        return glyph.floorOffset;
+    case Tile::Center:
+        return glyph.centerOffset;
+    }
+
+    return {0, 0};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool GlyphTileMap::isVisible(const GlyphCache::Glyph& glyph,
+    const PackedTile& tile)
+{
+    return glyph.textureRect.width > 0 && glyph.textureRect.height > 0
+        && tile.foreground.a > 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Vector2u GlyphTileMap::clipArea(const sf::Vector2u& coords,
+    const sf::Vector2u& area) const
+{
+    sf::Vector2u clipped = {0, 0};
+
+    if (coords.x < m_area.x) {
+        clipped.x = std::min(area.x, m_area.x - coords.x);
+    }
+
+    if (coords.y < m_area.y) {
+        clipped.y = std::min(area.y, m_area.y - coords.y);
+    }
+
+    return clipped;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::blankTiles(const sf::Vector2u& coords,
+    const sf::Vector2u& area)
+{
+    // The light map is stored by slot like the tiles, so the exposed slots
+    // would otherwise keep the light of whatever scrolled out of them.
+    if (!m_light.empty()) {
+        forEachRun(coords, clipArea(coords, area), [&](sf::Uint32 index,
+            sf::Uint32 count, const sf::Vector2u&, const sf::Vector2u&) {
+            std::fill(m_light.begin() + index, m_light.begin() + index
+                + count, sf::Color::White);
+        });
+    }
+
+    fillTiles(coords, area, blankTile());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::invalidateTiles(const sf::Vector2u& coords,
+    const sf::Vector2u& area, sf::Uint8 flags)
+{
+    if (area.x > 0 && area.y > 0) {
+        invalidateCache(coords.y, coords.y + area.y);
+
+        if (m_recorder) {
+            m_recorder->markTiles(coords, area, flags);
+        }
+    }
+
+    forEachRun(coords, area, [&](sf::Uint32 index, sf::Uint32 count,
+        const sf::Vector2u& cell, const sf::Vector2u&) {
+        if (m_deferred) {
+            for (sf::Uint32 x = 0; x < count; ++x) {
+                m_dirtyTiles[index + x] |= flags;
+            }
+            m_dirtyRows[cell.y] = 1;
+            m_dirty = true;
+        } else if (flags == DirtyAll) {
+            GLYPH_TILE_MAP_TIME(m_stats.updateTime);
+            sf::Uint32 quadCount = updateRun(index, count, cell, true,
+                m_overhang);
+            static_cast<void>(quadCount);
+            GLYPH_TILE_MAP_COUNT(m_stats.tilesUpdated += count);
+            GLYPH_TILE_MAP_COUNT(m_stats.verticesWritten += quadCount * 4);
+            m_backgroundDirtyTop = std::min(m_backgroundDirtyTop, cell.y);
+            m_backgroundDirtyBottom = std::max(m_backgroundDirtyBottom,
+                cell.y + 1);
+        } else {
+            GLYPH_TILE_MAP_TIME(m_stats.updateTime);
+            for (sf::Uint32 x = 0; x < count; ++x) {
+                updateTile(index + x, {cell.x + x, cell.y}, flags);
+            }
+        }
+    });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::ensureVerticesUpdate() const
+{
+    if (!m_dirty) {
+        return;
+    }
+
+    GLYPH_TILE_MAP_TIME(m_stats.updateTime);
+
+    for (sf::Uint32 y = 0; y < m_area.y; ++y) {
+        if (!m_dirtyRows[y]) {
+            continue;
+        }
+
+        sf::Uint32 index = y * m_area.x;
+
+        for (sf::Uint32 x = 0; x < m_area.x; ++x) {
+            if (m_dirtyTiles[index + x]) {
+                updateTile(index + x, {x, y}, m_dirtyTiles[index + x]);
+                m_dirtyTiles[index + x] = 0;
+            }
+        }
+
+        m_dirtyRows[y] = 0;
+    }
+
+    m_dirty = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::ensureBackgroundUpdate() const
+{
+    static_assert(sizeof(sf::Color) == 4, "sf::Color must be packed RGBA");
+
+    if (m_background.empty()) {
+        return;
+    }
+
+    GLYPH_TILE_MAP_TIME(m_stats.updateTime);
+
+    if (m_backgroundTexture.getSize() != m_area) {
+        m_backgroundTexture.create(m_area.x, m_area.y);
+        m_backgroundTexture.setRepeated(true);
+        m_backgroundDirtyTop = 0;
+        m_backgroundDirtyBottom = m_area.y;
+    }
+
+    if (m_backgroundDirtyTop >= m_backgroundDirtyBottom) {
+        return;
+    }
+
+    // Recount the dirty rows' visible backgrounds; with none left at all the
+    // background quad is not drawn.
+    for (sf::Uint32 y = m_backgroundDirtyTop; y < m_backgroundDirtyBottom;
+        ++y) {
+        const sf::Color* row = &m_background[y * m_area.x];
+        sf::Uint32 count = static_cast<sf::Uint32>(std::count_if(row,
+            row + m_area.x, [](const sf::Color& color) {
+                return color.a > 0;
+            }));
+
+        m_visibleBackgrounds += count - m_visibleBackgroundRows[y];
+        m_visibleBackgroundRows[y] = count;
+    }
+
+    m_backgroundTexture.update(reinterpret_cast<const sf::Uint8*>(
+        &m_background[m_backgroundDirtyTop * m_area.x]), m_area.x,
+        m_backgroundDirtyBottom - m_backgroundDirtyTop, 0,
+        m_backgroundDirtyTop);
+
+    m_backgroundDirtyTop = m_area.y;
+    m_backgroundDirtyBottom = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::applyLightMap()
+{
+    GLYPH_TILE_MAP_TIME(m_stats.updateTime);
+
+    sf::Color colors[QuadRunSize];
+    sf::Color tints[QuadRunSize];
+    sf::Uint32 tileCount = static_cast<sf::Uint32>(m_tiles.size());
+    sf::Uint32 quadCount = static_cast<sf::Uint32>(m_quadTiles.size());
+
+    // Colors are gathered out of the PackedTiles in runs so the tints are
+    // applied to contiguous channels. Positions and texture coordinates are
+    // left as they are.
+    for (sf::Uint32 index = 0; index < tileCount; index += QuadRunSize) {
+        sf::Uint32 count = std::min(QuadRunSize, tileCount - index);
+
+        for (sf::Uint32 i = 0; i < count; ++i) {
+            colors[i] = m_tiles[index + i].background;
+        }
+
+        if (m_light.empty()) {
+            std::copy(colors, colors + count, &m_background[index]);
+        } else {
+            modulateColors(&m_background[index], colors, &m_light[index],
+                count);
+        }
+    }
+
+    for (sf::Uint32 quad = 0; quad < quadCount; quad += QuadRunSize) {
+        sf::Uint32 count = std::min(QuadRunSize, quadCount - quad);
+
+        for (sf::Uint32 i = 0; i < count; ++i) {
+            sf::Uint32 index = m_quadTiles[quad + i];
+
+            colors[i] = m_tiles[index].foreground;
+            tints[i] = m_light.empty() ? sf::Color::White : m_light[index];
+        }
+
+        modulateColors(colors, colors, tints, count);
+
+        for (sf::Uint32 i = 0; i < count; ++i) {
+            writeQuadColor(&m_foreground[(quad + i) * 4], colors[i]);
+        }
+    }
+
+    m_backgroundDirtyTop = 0;
+    m_backgroundDirtyBottom = m_area.y;
+    invalidateCache(0, m_area.y);
+
+    GLYPH_TILE_MAP_COUNT(m_stats.verticesWritten += quadCount * 4);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const GlyphCache::Glyph& GlyphTileMap::getGlyph(sf::Uint32 codepoint) const
+{
+#ifdef GLYPH_TILE_MAP_STATS
+    // The GlyphCache may be shared, so this map's part of its misses and
+    // growths is counted around each of its own lookups.
+    sf::Uint64 misses = m_glyphCache->getMisses();
+    sf::Uint32 growths = m_glyphCache->getAtlasGrowths();
+    const GlyphCache::Glyph& glyph = m_glyphCache->get(codepoint);
+
+    ++m_stats.glyphLookups;
+    m_stats.glyphCacheMisses += m_glyphCache->getMisses() - misses;
+    m_stats.atlasGrowths += m_glyphCache->getAtlasGrowths() - growths;
+
+    return glyph;
+#else
+    return m_glyphCache->get(codepoint);
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Vector2u GlyphTileMap::getOverhang(const sf::Vector2i& offset,
+    const sf::IntRect& textureRect) const
+{
+    return {getTileOverhang(offset.x, textureRect.width, m_spacing.x),
+        getTileOverhang(offset.y, textureRect.height, m_spacing.y)};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::raiseOverhang(sf::Vector2u& overhang,
+    const sf::Vector2u& other)
+{
+    overhang.x = std::max(overhang.x, other.x);
+    overhang.y = std::max(overhang.y, other.y);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Color GlyphTileMap::getLitColor(const sf::Color& color,
+    sf::Uint32 index) const
+{
+    return m_light.empty() ? color : modulateColor(color, m_light[index]);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 GlyphTileMap::acquireQuad(sf::Uint32 index) const
+{
+    if (m_quads[index] == NoQuad) {
+        m_quads[index] = static_cast<sf::Uint32>(m_quadTiles.size());
+        m_quadTiles.push_back(index);
+        m_foreground.resize(m_foreground.size() + 4);
+    }
+
+    return m_quads[index];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::releaseQuad(sf::Uint32 index) const
+{
+    sf::Uint32 quad = m_quads[index];
+
+    if (quad == NoQuad) {
+        return;
+    }
+
+    // Move the last quad into the hole to keep m_foreground compact.
+    sf::Uint32 last = static_cast<sf::Uint32>(m_quadTiles.size()) - 1;
+
+    if (quad != last) {
+        std::copy(m_foreground.begin() + (last * 4),
+            m_foreground.begin() + (last * 4) + 4,
+            m_foreground.begin() + (quad * 4));
+        m_quadTiles[quad] = m_quadTiles[last];
+        m_quads[m_quadTiles[quad]] = quad;
+    }
+
+    m_quadTiles.pop_back();
+    m_foreground.resize(last * 4);
+    m_quads[index] = NoQuad;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::updateTile(sf::Uint32 index, const sf::Vector2u& cell,
+    sf::Uint8 flags) const
+{
+    const PackedTile& tile = m_tiles[index];
+
+    GLYPH_TILE_MAP_COUNT(++m_stats.tilesUpdated);
+
+    // A color change can make a glyph appear or disappear as well.
+    if (flags & (DirtyCharacter | DirtyForeground)) {
+        const GlyphCache::Glyph& glyph = getGlyph(tile.getCodepoint());
+
+        if (isVisible(glyph, tile)) {
+            if (m_quads[index] == NoQuad) {
+                flags |= DirtyCharacter | DirtyForeground;
+            }
+
+            sf::Vertex* quad = &m_foreground[acquireQuad(index) * 4];
+
+            GLYPH_TILE_MAP_COUNT(m_stats.verticesWritten += 4);
+
+            if (flags & DirtyCharacter) {
+                sf::Vector2i offset = getAdjustedOffset(glyph,
+                    tile.getType(), tile.getOffset());
+                sf::Vector2f position = getCellPosition(cell);
+
+                writeForegroundQuad(quad, position.x + offset.x,
+                    position.y + offset.y, glyph.textureRect);
+                raiseOverhang(m_overhang, getOverhang(offset,
+                    glyph.textureRect));
+            }
+
+            if (flags & DirtyForeground) {
+                writeQuadColor(quad, getLitColor(tile.foreground, index));
+            }
+        } else {
+            releaseQuad(index);
+        }
+    }
+
+    if (flags & DirtyBackground) {
+        m_background[index] = getLitColor(tile.background, index);
+        m_backgroundDirtyTop = std::min(m_backgroundDirtyTop, cell.y);
+        m_backgroundDirtyBottom = std::max(m_backgroundDirtyBottom,
+            cell.y + 1);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::updateRows(sf::Uint32 top, sf::Uint32 bottom,
+    sf::Vector2u& overhang) const
+{
+    // Safe to run concurrently on disjoint rows: glyphs are only read from
+    // the cache, and the background dirty range and overhang are left to
+    // the caller.
+    for (sf::Uint32 y = top; y < bottom; ++y) {
+        updateRun(y * m_area.x, m_area.x, {0, y}, false, overhang);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 GlyphTileMap::updateRun(sf::Uint32 index, sf::Uint32 count,
+    const sf::Vector2u& cell, bool loadGlyphs, sf::Vector2u& overhang) const
+{
+    float x[QuadRunSize];
+    float y[QuadRunSize];
+    float left[QuadRunSize];
+    float top[QuadRunSize];
+    float width[QuadRunSize];
+    float height[QuadRunSize];
+    sf::Color color[QuadRunSize];
+    QuadRun run = {x, y, left, top, width, height, color};
+    sf::Uint32 start = 0;
+    sf::Uint32 pending = 0;
+    sf::Uint32 written = 0;
+
+    // Quads are batched for as long as their slots are consecutive, which
+    // they are after a rebuild. Without loadGlyphs, quads must already be
+    // assigned, so the run only reads shared state.
+    for (sf::Uint32 i = 0; i < count; ++i) {
+        const PackedTile& tile = m_tiles[index + i];
+        const GlyphCache::Glyph* glyph = loadGlyphs
+            ? &getGlyph(tile.getCodepoint())
+            : m_glyphCache->find(tile.getCodepoint());
+        sf::Uint32 quad = m_quads[index + i];
+
+        m_background[index + i] = getLitColor(tile.background, index + i);
+
+        if (loadGlyphs) {
+            if (!isVisible(*glyph, tile)) {
+                if (quad != NoQuad) {
+                    if (pending > 0) {
+                        writeQuads(&m_foreground[start * 4], run, pending);
+                        pending = 0;
+                    }
+                    releaseQuad(index + i);
+                }
+                continue;
+            }
+
+            quad = acquireQuad(index + i);
+        }
+
+        if (quad == NoQuad) {
+            continue;
+        }
+
+        if (pending > 0 && quad != start + pending) {
+            writeQuads(&m_foreground[start * 4], run, pending);
+            pending = 0;
+        }
+
+        if (pending == 0) {
+            start = quad;
+        }
+
+        sf::Vector2i offset = getAdjustedOffset(*glyph, tile.getType(),
+            tile.getOffset());
+        sf::Vector2f position = getCellPosition({cell.x + i, cell.y});
+
+        raiseOverhang(overhang, getOverhang(offset, glyph->textureRect));
+        x[pending] = position.x + offset.x;
+        y[pending] = position.y + offset.y;
+        left[pending] = static_cast<float>(glyph->textureRect.left);
+        top[pending] = static_cast<float>(glyph->textureRect.top);
+        width[pending] = static_cast<float>(glyph->textureRect.width);
+        height[pending] = static_cast<float>(glyph->textureRect.height);
+        color[pending] = getLitColor(tile.foreground, index + i);
+        ++written;
+
+        if (++pending == QuadRunSize) {
+            writeQuads(&m_foreground[start * 4], run, pending);
+            pending = 0;
+        }
+    }
+
+    if (pending > 0) {
+        writeQuads(&m_foreground[start * 4], run, pending);
+    }
+
+    return written;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::writeForegroundQuad(sf::Vertex* quad, float x, float y,
+    const sf::IntRect& textureRect)
+{
+    float width = static_cast<float>(textureRect.width);
+    float height = static_cast<float>(textureRect.height);
+    float left = static_cast<float>(textureRect.left);
+    float top = static_cast<float>(textureRect.top);
+
+    quad[0].position = {x, y};
+    quad[1].position = {x + width, y};
+    quad[2].position = {x + width, y + height};
+    quad[3].position = {x, y + height};
+    quad[0].texCoords = {left, top};
+    quad[1].texCoords = {left + width, top};
+    quad[2].texCoords = {left + width, top + height};
+    quad[3].texCoords = {left, top + height};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::writeBackgroundQuad(sf::Vertex* quad, float x, float y,
+    float width, float height)
+{
+    quad[0].position = {x, y};
+    quad[1].position = {x + width, y};
+    quad[2].position = {x + width, y + height};
+    quad[3].position = {x, y + height};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileMap::writeQuadColor(sf::Vertex* quad, const sf::Color& color)
+{
+    quad[0].color = color;
+    quad[1].color = color;
+    quad[2].color = color;
+    quad[3].color = color;
+}
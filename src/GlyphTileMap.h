@@ -14,9 +14,18 @@
 /// Headers
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <SFML/System.hpp>
 #include <SFML/Graphics.hpp>
 
+#include "GlyphCache.h"
+
+class BakedGlyphAtlas;
+class GlyphTileRecorder;
+
 class GlyphTileMap : public sf::Drawable, public sf::Transformable {
 public:
 
@@ -69,6 +78,111 @@ public:
         sf::Color background;
     };
 
+    ///////////////////////////////////////////////////////////////////////////
+    /// GlyphRange is an inclusive range of Unicode codepoints.
+    ///////////////////////////////////////////////////////////////////////////
+    struct GlyphRange {
+        sf::Uint32 first;
+        sf::Uint32 last;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// Charset names a predefined set of codepoints to prewarm. The sets are:
+    ///
+    /// Ascii:      The printable ASCII characters (U+0020 to U+007E)
+    /// CP437:      The 256 characters of IBM code page 437, as used by most
+    ///             roguelike tilesets
+    /// BoxDrawing: The Box Drawing and Block Elements blocks (U+2500 to
+    ///             U+259F)
+    ///////////////////////////////////////////////////////////////////////////
+    enum Charset { Ascii, CP437, BoxDrawing };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// PrewarmReport describes the work done by a prewarm:
+    ///
+    /// glyphCount:         Number of codepoints that were rasterized
+    /// atlasGrowths:       Number of times the font's texture atlas was
+    ///                     reallocated to make room for new glyphs
+    /// rasterizationTime:  Time spent rasterizing the glyphs
+    ///////////////////////////////////////////////////////////////////////////
+    struct PrewarmReport {
+        sf::Uint32 glyphCount;
+        sf::Uint32 atlasGrowths;
+        sf::Time rasterizationTime;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// FrameStats describes the work done since the last resetFrameStats():
+    ///
+    /// tilesUpdated:       Number of tiles whose vertices were brought up to
+    ///                     date (a tile updated twice counts twice)
+    /// verticesWritten:    Number of foreground vertices rewritten
+    /// glyphLookups:       Number of glyph cache lookups made by this map
+    /// glyphCacheMisses:   Number of those lookups that had to load a glyph
+    /// atlasSize:          Current size of the glyph atlas texture
+    /// atlasGrowths:       Number of times those loads grew the atlas
+    /// verticesSubmitted:  Number of vertices passed to the render target
+    /// drawCalls:          Number of draw calls made by draw()
+    /// updateTime:         Time spent updating vertices and backgrounds
+    /// drawTime:           Time spent in draw() submitting vertices
+    ///
+    /// The counters are only kept when GLYPH_TILE_MAP_STATS is defined while
+    /// compiling GlyphTileMap.cpp; otherwise they cost nothing and stay zero.
+    ///////////////////////////////////////////////////////////////////////////
+    struct FrameStats {
+        sf::Uint64 tilesUpdated;
+        sf::Uint64 verticesWritten;
+        sf::Uint64 glyphLookups;
+        sf::Uint64 glyphCacheMisses;
+        sf::Vector2u atlasSize;
+        sf::Uint32 atlasGrowths;
+        sf::Uint64 verticesSubmitted;
+        sf::Uint32 drawCalls;
+        sf::Time updateTime;
+        sf::Time drawTime;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the codepoints of a predefined Charset
+    ///
+    /// \param charset  Charset to return the codepoints of
+    ///
+    /// \return the codepoints of charset
+    ///////////////////////////////////////////////////////////////////////////
+    static std::vector<sf::Uint32> getCharset(Charset charset);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the codepoints of a list of GlyphRanges
+    ///
+    /// \param ranges   Inclusive ranges of codepoints, in the order in which
+    ///                 they should be prewarmed
+    ///
+    /// \return the codepoints of ranges
+    ///////////////////////////////////////////////////////////////////////////
+    static std::vector<sf::Uint32> getCharset(
+        const std::vector<GlyphRange>& ranges);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Rasterizes glyphs into an sf::Font's atlas ahead of time
+    ///
+    /// sf::Font rasterizes a glyph the first time it is requested and grows
+    /// its texture atlas (reallocating and copying it) whenever a page fills
+    /// up, which causes frame hitches when it happens mid-game. Prewarming
+    /// moves that work to load time. The atlas position of a glyph depends
+    /// on the order glyphs are rasterized in, but what is drawn does not.
+    ///
+    /// Use this to share a prewarm between several maps using the same font,
+    /// e.g. the chunks of a ChunkedGlyphTileMap.
+    ///
+    /// \param font             Font to rasterize the glyphs with
+    /// \param characterSize    Character size to rasterize the glyphs at
+    /// \param codepoints       Codepoints to rasterize
+    ///
+    /// \return a PrewarmReport of the work done
+    ///////////////////////////////////////////////////////////////////////////
+    static PrewarmReport prewarmFont(sf::Font& font, sf::Uint32 characterSize,
+        const std::vector<sf::Uint32>& codepoints);
+
     ///////////////////////////////////////////////////////////////////////////
     /// \brief Constructor
     ///
@@ -78,10 +192,42 @@ public:
     //                          tiles
     /// \param spacing          Width and height of each tile in pixels
     /// \param characterSize    Size of each glyph
+    ///
+    /// Background colors are stored as one texel per tile, so area must fit
+    /// within sf::Texture::getMaximumSize() in both dimensions.
     ///////////////////////////////////////////////////////////////////////////
     GlyphTileMap(sf::Font& font, const sf::Vector2u& area,
         const sf::Vector2u& spacing, sf::Uint32 characterSize);
 
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor taking glyphs from a BakedGlyphAtlas
+    ///
+    /// Glyph metrics and the atlas texture come from the baked atlas instead
+    /// of an sf::Font, so nothing is rasterized at runtime. Codepoints that
+    /// were not baked are drawn as U+FFFD if it was baked, or left empty.
+    ///
+    /// \param atlas    Reference to a loaded BakedGlyphAtlas, which must
+    ///                 outlive the GlyphTileMap
+    /// \param area     Width and height of the GlyphTileMap in # of tiles
+    /// \param spacing  Width and height of each tile in pixels
+    ///////////////////////////////////////////////////////////////////////////
+    GlyphTileMap(const BakedGlyphAtlas& atlas, const sf::Vector2u& area,
+        const sf::Vector2u& spacing);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor sharing a GlyphCache with other GlyphTileMaps
+    ///
+    /// Each glyph is then looked up and placed once for all the maps sharing
+    /// the cache, which also share its hit and miss counts. The tiles take
+    /// the cache's spacing.
+    ///
+    /// \param glyphCache   GlyphCache to take glyphs from, which must not be
+    ///                     null
+    /// \param area         Width and height of the GlyphTileMap in # of tiles
+    ///////////////////////////////////////////////////////////////////////////
+    GlyphTileMap(const std::shared_ptr<GlyphCache>& glyphCache,
+        const sf::Vector2u& area);
+
     ///////////////////////////////////////////////////////////////////////////
     /// \brief Returns a const reference to the area of the GlyphTileMap
     ///
@@ -103,6 +249,105 @@ public:
     ///////////////////////////////////////////////////////////////////////////
     sf::Uint32 getCharacterSize() const;
 
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the Tile at a coords
+    ///
+    /// Every tile starts out as a blank Tile (L' ', Center, White foreground,
+    /// Transparent background). Tiles are stored packed, so characters past
+    /// U+10FFFF read back as U+FFFD and offsets are clamped to [-128, 127].
+    ///
+    /// \param coords   Coordinates in the GlyphTileMap to read
+    ///
+    /// \return the Tile at coords
+    ///////////////////////////////////////////////////////////////////////////
+    Tile getTile(const sf::Vector2u& coords) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Enables or disables deferred vertex generation
+    ///
+    /// By default every setter regenerates the vertices of the tiles it
+    /// touches immediately. When deferred, setters only record the new Tile
+    /// state and mark it dirty; the vertices of dirty tiles are regenerated
+    /// once by commit() or the next draw, so a tile changed several times in
+    /// a frame is only rebuilt once. Disabling commits pending changes.
+    ///
+    /// \param deferred True to defer vertex generation until commit/draw
+    ///////////////////////////////////////////////////////////////////////////
+    void setDeferred(bool deferred);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns whether vertex generation is deferred
+    ///
+    /// \return true if vertex generation is deferred
+    ///////////////////////////////////////////////////////////////////////////
+    bool isDeferred() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Regenerates the vertices of all dirty tiles
+    ///
+    /// Only needed in deferred mode, and only to control when the work
+    /// happens; draw() commits on its own.
+    ///////////////////////////////////////////////////////////////////////////
+    void commit();
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Sets whether the map is drawn from a cached render
+    ///
+    /// A cached map renders itself into an internal sf::RenderTexture and
+    /// draw() submits a single textured quad. When tiles change, only the
+    /// bands of rows they touch (widened by how far glyphs overhang their
+    /// tiles) are re-rendered, so a map that does not change costs next to
+    /// nothing to draw. Worth it for panels and screens that change rarely;
+    /// a map that changes every frame is better left uncached.
+    ///
+    /// The cached render is composited with premultiplied alpha, so the
+    /// result looks the same, but the blend mode passed to draw() is ignored.
+    ///
+    /// \param cached   True to draw from a cached render
+    ///////////////////////////////////////////////////////////////////////////
+    void setCached(bool cached);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns whether the map is drawn from a cached render
+    ///
+    /// \return true if the map is drawn from a cached render
+    ///////////////////////////////////////////////////////////////////////////
+    bool isCached() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Attaches a GlyphTileRecorder to the map, or detaches it
+    ///
+    /// While attached, every change to a tile and every scroll is reported
+    /// to the recorder, which records the tiles' final state once per frame
+    /// in GlyphTileRecorder::recordFrame(). Attaching marks every tile, so
+    /// the next frame recorded holds the whole map.
+    ///
+    /// \param recorder GlyphTileRecorder with the map's area, which must
+    ///                 stay alive while attached, or nullptr to detach
+    ///////////////////////////////////////////////////////////////////////////
+    void setRecorder(GlyphTileRecorder* recorder);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the attached GlyphTileRecorder
+    ///
+    /// \return the attached GlyphTileRecorder, or nullptr
+    ///////////////////////////////////////////////////////////////////////////
+    GlyphTileRecorder* getRecorder() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Regenerates the vertices of every tile using several threads
+    ///
+    /// Meant for when most of the map changes at once (level loads, full
+    /// repaints in deferred mode). Glyphs are resolved on the calling thread
+    /// first, since sf::Font is not thread-safe; the grid is then split into
+    /// bands of rows that worker threads claim until none are left. The
+    /// result is identical to a single-threaded rebuild.
+    ///
+    /// \param threadCount  Number of threads to use, including the calling
+    ///                     thread (default 0, one per hardware thread)
+    ///////////////////////////////////////////////////////////////////////////
+    void rebuild(sf::Uint32 threadCount = 0);
+
     ///////////////////////////////////////////////////////////////////////////
     /// \brief Updates the GlyphTileMap at a coords with data from a Tile
     ///
@@ -111,6 +356,20 @@ public:
     ///////////////////////////////////////////////////////////////////////////
     void setTile(const sf::Vector2u& coords, const Tile& tile);
 
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Scrolls the contents of the GlyphTileMap
+    ///
+    /// Moves the contents by (-dx, -dy) tiles, as if the map were a window
+    /// panning over a larger world: the tile at (x + dx, y + dy) ends up at
+    /// (x, y), and the rows and columns exposed along the opposite edges
+    /// are reset to blank, unlit Tiles for the caller to fill in. The grid
+    /// is kept as a ring buffer, so only the exposed tiles are rebuilt.
+    ///
+    /// \param dx   Number of columns to scroll by (positive scrolls right)
+    /// \param dy   Number of rows to scroll by (positive scrolls down)
+    ///////////////////////////////////////////////////////////////////////////
+    void scroll(sf::Int32 dx, sf::Int32 dy);
+
     ///////////////////////////////////////////////////////////////////////////
     /// \brief Updates the character at a coords in the GlyphTileMap
     ///
@@ -139,18 +398,422 @@ public:
     ///////////////////////////////////////////////////////////////////////////
     void setTileBackground(const sf::Vector2u& coords, const sf::Color& color);
 
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates a rectangle of the GlyphTileMap with data from a Tile
+    ///
+    /// The glyph is looked up once and each row is written as a contiguous
+    /// range of vertices. The rectangle is clipped to the GlyphTileMap.
+    ///
+    /// \param coords   Coordinates of the top left tile of the rectangle
+    /// \param area     Width and height of the rectangle in # of tiles
+    /// \param tile     GlyphTileMap::Tile to fill the rectangle with
+    ///////////////////////////////////////////////////////////////////////////
+    void fillTiles(const sf::Vector2u& coords, const sf::Vector2u& area,
+        const Tile& tile);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates a rectangle of the GlyphTileMap from an array of Tiles
+    ///
+    /// The rectangle is clipped to the GlyphTileMap; Tiles falling outside of
+    /// it are skipped.
+    ///
+    /// \param coords   Coordinates of the top left tile of the rectangle
+    /// \param area     Width and height of the rectangle in # of tiles
+    /// \param tiles    Row-major array of area.x * area.y GlyphTileMap::Tiles
+    ///////////////////////////////////////////////////////////////////////////
+    void setTiles(const sf::Vector2u& coords, const sf::Vector2u& area,
+        const Tile* tiles);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates a whole row of the GlyphTileMap from an array of Tiles
+    ///
+    /// \param row      Index of the row to update
+    /// \param tiles    Array of getArea().x GlyphTileMap::Tiles
+    ///////////////////////////////////////////////////////////////////////////
+    void setTileRow(sf::Uint32 row, const Tile* tiles);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates the character of a rectangle of the GlyphTileMap
+    ///
+    /// \param coords       Coordinates of the top left tile of the rectangle
+    /// \param area         Width and height of the rectangle in # of tiles
+    /// \param character    New character for the tiles
+    /// \param type         Tile::Type of the new character (default Center)
+    /// \param offset       Exact spacing offset value of the new character
+    ///                     (default {0, 0})
+    ///////////////////////////////////////////////////////////////////////////
+    void fillTileCharacter(const sf::Vector2u& coords, const sf::Vector2u& area,
+        wchar_t character, Tile::Type type = Tile::Center,
+        const sf::Vector2i& offset = {0, 0});
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates the foreground color of a rectangle of the GlyphTileMap
+    ///
+    /// \param coords   Coordinates of the top left tile of the rectangle
+    /// \param area     Width and height of the rectangle in # of tiles
+    /// \param color    New foreground color for the tiles
+    ///////////////////////////////////////////////////////////////////////////
+    void fillTileForeground(const sf::Vector2u& coords,
+        const sf::Vector2u& area, const sf::Color& color);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates the background color of a rectangle of the GlyphTileMap
+    ///
+    /// \param coords   Coordinates of the top left tile of the rectangle
+    /// \param area     Width and height of the rectangle in # of tiles
+    /// \param color    New background color for the tiles
+    ///////////////////////////////////////////////////////////////////////////
+    void fillTileBackground(const sf::Vector2u& coords,
+        const sf::Vector2u& area, const sf::Color& color);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Copies a rectangle of tiles from a GlyphTileMap into this one
+    ///
+    /// When both maps use the same sf::Font or BakedGlyphAtlas with the same
+    /// spacing and character size, the tiles' quads are copied along with
+    /// them and moved into place, without looking up or placing any glyphs.
+    /// Otherwise the copied tiles are rebuilt as by setTiles(). The
+    /// rectangle is clipped to both maps, and may overlap itself when source
+    /// is this map.
+    ///
+    /// \param source       GlyphTileMap to copy from, which may be this one
+    /// \param sourceCoords Coordinates of the top left tile to copy
+    /// \param area         Width and height of the rectangle in # of tiles
+    /// \param coords       Coordinates of the top left tile to copy to
+    /// \param mask         Optional area.x * area.y bytes in row order; tiles
+    ///                     whose byte is 0 are transparent and not copied
+    ///////////////////////////////////////////////////////////////////////////
+    void blit(const GlyphTileMap& source, const sf::Vector2u& sourceCoords,
+        const sf::Vector2u& area, const sf::Vector2u& coords,
+        const sf::Uint8* mask = nullptr);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Tints every tile with a light map
+    ///
+    /// Each tile's foreground and background colors are multiplied by its
+    /// tint, as a vertex color modulates a texture, so white leaves a tile
+    /// as it is and black darkens it fully. Only the RGB of the tints is
+    /// used. The tiles keep their own colors, which getTile() returns and
+    /// every later change is tinted from, so a light map can be set again
+    /// each turn without the colors drifting.
+    ///
+    /// The tint is applied to the vertex colors of the whole map in one
+    /// pass, without regenerating any glyph quads. The light map moves with
+    /// the tiles when the map is scrolled, and the rows and columns scroll()
+    /// exposes are unlit (white) until the light map is set again.
+    ///
+    /// \param tints    Row-major array of getArea().x * getArea().y tints
+    ///////////////////////////////////////////////////////////////////////////
+    void setLightMap(const sf::Color* tints);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Dims every tile with a light map of brightness levels
+    ///
+    /// Equivalent to setLightMap() with a gray tint of each level.
+    ///
+    /// \param levels   Row-major array of getArea().x * getArea().y levels,
+    ///                 from 0 (black) to 255 (unchanged)
+    ///////////////////////////////////////////////////////////////////////////
+    void setLightMap(const sf::Uint8* levels);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Removes the light map, drawing every tile in its own colors
+    ///////////////////////////////////////////////////////////////////////////
+    void clearLightMap();
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Writes a snapshot of every tile to a file
+    ///
+    /// The file holds a header with the area, spacing and character size of
+    /// the map, followed by its tiles in rows, packed as they are stored.
+    /// It is written in one sequential pass. Tiles are byte-oriented, so
+    /// only the header depends on the byte order of the machine.
+    ///
+    /// \param filename Path of the file to write
+    ///
+    /// \return true if the file was written
+    ///////////////////////////////////////////////////////////////////////////
+    bool saveToFile(const std::string& filename) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Replaces every tile with a snapshot written by saveToFile()
+    ///
+    /// The file is memory-mapped and its tiles copied straight into the map,
+    /// which is then rebuilt once with rebuild(). The snapshot's area,
+    /// spacing and character size must match the map's.
+    ///
+    /// \param filename Path of the file to load
+    ///
+    /// \return true if the snapshot was loaded; on failure the map is left
+    ///         unchanged
+    ///////////////////////////////////////////////////////////////////////////
+    bool loadFromFile(const std::string& filename);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Discards all cached glyph metrics and places every glyph again
+    ///
+    /// Glyph metrics are cached per character the first time they are used,
+    /// so sf::Font::getGlyph is only called once per character. Growth of the
+    /// font's texture atlas does not move existing glyphs and keeps the cache
+    /// valid, but reloading the sf::Font does not: call this after changing
+    /// the font, on every GlyphTileMap sharing its GlyphCache. All tiles are
+    /// then placed again from the reloaded font, and a cached render is
+    /// redrawn.
+    ///////////////////////////////////////////////////////////////////////////
+    void clearGlyphCache();
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of glyph lookups served by the cache
+    ///
+    /// Counts the lookups of every map sharing the GlyphCache; FrameStats
+    /// counts this map's own.
+    ///
+    /// \return the number of glyph cache hits
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint64 getGlyphCacheHits() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of glyph lookups that went to the sf::Font
+    ///
+    /// \return the number of glyph cache misses
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint64 getGlyphCacheMisses() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of quads culled by the last draw
+    ///
+    /// Only tiles with a non-empty glyph and a foreground that is not fully
+    /// transparent own a quad; every other tile counts as one culled quad.
+    /// The background quad is culled too while every background is fully
+    /// transparent.
+    ///
+    /// \return the number of quads culled by the last draw
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint32 getCulledQuadCount() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Draws only the backgrounds of the tiles
+    ///
+    /// Drawing the backgrounds of several maps before any of their
+    /// foregrounds keeps glyphs hanging over one map's edge from being
+    /// covered by the next map's backgrounds. The cached render is not used.
+    ///
+    /// \param target   Render target to draw to
+    /// \param states   Render states to use for drawing
+    ///////////////////////////////////////////////////////////////////////////
+    void drawBackground(sf::RenderTarget& target,
+        sf::RenderStates states = sf::RenderStates::Default) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Draws only the glyphs of the tiles
+    ///
+    /// \param target   Render target to draw to
+    /// \param states   Render states to use for drawing
+    ///
+    /// \see drawBackground
+    ///////////////////////////////////////////////////////////////////////////
+    void drawForeground(sf::RenderTarget& target,
+        sf::RenderStates states = sf::RenderStates::Default) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns how far glyphs reach past their tiles
+    ///
+    /// Tracked as glyphs are placed, so it covers every glyph placed so far
+    /// (in deferred mode, up to the last draw) and never shrinks.
+    ///
+    /// \return the most columns and rows any glyph has reached past either
+    ///         side of its tile
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Vector2u& getGlyphOverhang() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the work done since the last resetFrameStats()
+    ///
+    /// Call resetFrameStats() once per frame, e.g. after drawing, to read
+    /// per-frame numbers for a debug overlay or telemetry.
+    ///
+    /// \return the FrameStats, all zero without GLYPH_TILE_MAP_STATS
+    ///////////////////////////////////////////////////////////////////////////
+    FrameStats getFrameStats() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Starts counting a new frame of FrameStats
+    ///////////////////////////////////////////////////////////////////////////
+    void resetFrameStats();
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Rasterizes and caches glyphs at the map's character size
+    ///
+    /// Calls prewarmFont() with the map's font and character size, then
+    /// fills the glyph cache, so that setting tiles to any of the codepoints
+    /// later neither touches the sf::Font nor grows its atlas. Call it before
+    /// the game loop starts, e.g. with getCharset(CP437).
+    ///
+    /// Maps using a BakedGlyphAtlas have nothing to rasterize; only their
+    /// glyph cache is filled.
+    ///
+    /// \param codepoints   Codepoints to prewarm
+    ///
+    /// \return a PrewarmReport of the work done
+    ///////////////////////////////////////////////////////////////////////////
+    PrewarmReport prewarmGlyphs(const std::vector<sf::Uint32>& codepoints);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Draws the map into an RGBA pixel buffer on the CPU
+    ///
+    /// Produces what draw() would into a target of area * spacing pixels
+    /// cleared to clearColor, ignoring the map's transform: pixels are
+    /// identical wherever they are opaque, and blended edges of glyphs and
+    /// translucent colors are within one step of rounding. No OpenGL
+    /// context is needed for a map using a BakedGlyphAtlas; one using an
+    /// sf::Font copies its atlas back from the GPU when glyphs are loaded.
+    ///
+    /// \param pixels       Destination of getArea().x * getSpacing().x by
+    ///                     getArea().y * getSpacing().y RGBA pixels, in rows
+    /// \param clearColor   Color of the pixels beneath the map
+    ///////////////////////////////////////////////////////////////////////////
+    void render(sf::Uint8* pixels,
+        const sf::Color& clearColor = sf::Color::Black) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Draws the map into an sf::Image on the CPU
+    ///
+    /// Same as render(sf::Uint8*, const sf::Color&), creating image at the
+    /// size of the map. The pixels are drawn into a buffer first, since
+    /// sf::Image cannot be written in place; pass a buffer when rendering
+    /// many frames.
+    ///
+    /// \param image        Image to draw into
+    /// \param clearColor   Color of the pixels beneath the map
+    ///////////////////////////////////////////////////////////////////////////
+    void render(sf::Image& image,
+        const sf::Color& clearColor = sf::Color::Black) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns where a glyph is placed within its tile
+    ///
+    /// \param glyph    Cached metrics of the glyph
+    /// \param type     Tile::Type of the tile
+    /// \param offset   Exact spacing offset value of the tile
+    ///
+    /// \return the offset of the glyph's quad from the tile's top left corner
+    ///////////////////////////////////////////////////////////////////////////
+    static sf::Vector2i getAdjustedOffset(const GlyphCache::Glyph& glyph,
+        Tile::Type type, const sf::Vector2i& offset);
+
 private:
 
+    ///////////////////////////////////////////////////////////////////////////
+    /// PackedTile is the stored form of a Tile, 13 bytes instead of 24: a
+    /// 21-bit codepoint and 2-bit Type share three bytes, followed by 8-bit
+    /// offsets and the two colors.
+    ///////////////////////////////////////////////////////////////////////////
+    struct PackedTile {
+        PackedTile();
+        PackedTile(const Tile& tile);
+        Tile unpack() const;
+        sf::Uint32 getCodepoint() const;
+        Tile::Type getType() const;
+        sf::Vector2i getOffset() const;
+        void setCharacter(wchar_t character, Tile::Type type,
+            const sf::Vector2i& offset);
+
+        sf::Uint8 glyph[3];
+        sf::Int8 offset[2];
+        sf::Color foreground;
+        sf::Color background;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// SnapshotHeader is the start of a file written by saveToFile(). It is
+    /// followed by width * height PackedTiles.
+    ///////////////////////////////////////////////////////////////////////////
+    struct SnapshotHeader {
+        char magic[4];
+        sf::Uint32 version;
+        sf::Uint32 width;
+        sf::Uint32 height;
+        sf::Uint32 spacingX;
+        sf::Uint32 spacingY;
+        sf::Uint32 characterSize;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// Only tiles with a visible glyph own a quad in m_foreground; m_quads
+    /// maps each tile to its quad (or NoQuad) and m_quadTiles maps back.
+    /// Quads are acquired and released as tiles change, so the draw list
+    /// never holds blank or transparent glyphs.
+    ///////////////////////////////////////////////////////////////////////////
+    static const sf::Uint32 NoQuad = 0xFFFFFFFF;
+
+    ///////////////////////////////////////////////////////////////////////////
+    static const sf::Uint32 MaxCodepoint = 0x10FFFF;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// Dirty flags record which parts of a tile's vertices are out of date.
+    /// They are passed on as the GlyphTileRecorder::Channels a change touched.
+    ///////////////////////////////////////////////////////////////////////////
+    enum Dirty : sf::Uint8 {
+        DirtyCharacter = 1 << 0,
+        DirtyForeground = 1 << 1,
+        DirtyBackground = 1 << 2,
+        DirtyAll = DirtyCharacter | DirtyForeground | DirtyBackground
+    };
+
     ///////////////////////////////////////////////////////////////////////////
     ///
     ///////////////////////////////////////////////////////////////////////////
     virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
 
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void drawLayers(sf::RenderTarget& target, sf::RenderStates states) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void drawBackgroundLayer(sf::RenderTarget& target,
+        sf::RenderStates states) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void drawForegroundLayer(sf::RenderTarget& target,
+        sf::RenderStates states) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool ensureCacheUpdate() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void invalidateCache(sf::Uint32 top, sf::Uint32 bottom);
+
     ///////////////////////////////////////////////////////////////////////////
     ///
     ///////////////////////////////////////////////////////////////////////////
     sf::Uint32 getIndex(const sf::Vector2u& coords) const;
 
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Vector2u getCell(const sf::Vector2u& coords) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Vector2f getCellPosition(const sf::Vector2u& cell) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    template <typename F>
+    void forEachRun(const sf::Vector2u& coords, const sf::Vector2u& area,
+        F function) const;
+
     ///////////////////////////////////////////////////////////////////////////
     ///
     ///////////////////////////////////////////////////////////////////////////
@@ -159,44 +822,139 @@ private:
     ///////////////////////////////////////////////////////////////////////////
     ///
     ///////////////////////////////////////////////////////////////////////////
-    void updateTile(const sf::Vector2u& coords, const Tile& tile);
+    static bool isVisible(const GlyphCache::Glyph& glyph,
+        const PackedTile& tile);
 
     ///////////////////////////////////////////////////////////////////////////
     ///
     ///////////////////////////////////////////////////////////////////////////
-    void updateCharacter(const sf::Vector2u& coords, wchar_t character,
-        Tile::Type type, const sf::Vector2i& offset);
+    sf::Vector2u clipArea(const sf::Vector2u& coords,
+        const sf::Vector2u& area) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void blankTiles(const sf::Vector2u& coords, const sf::Vector2u& area);
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void invalidateTiles(const sf::Vector2u& coords, const sf::Vector2u& area,
+        sf::Uint8 flags);
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void ensureVerticesUpdate() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void applyLightMap();
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const GlyphCache::Glyph& getGlyph(sf::Uint32 codepoint) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Vector2u getOverhang(const sf::Vector2i& offset,
+        const sf::IntRect& textureRect) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static void raiseOverhang(sf::Vector2u& overhang,
+        const sf::Vector2u& other);
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Color getLitColor(const sf::Color& color, sf::Uint32 index) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint32 acquireQuad(sf::Uint32 index) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void releaseQuad(sf::Uint32 index) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void ensureBackgroundUpdate() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void updateTile(sf::Uint32 index, const sf::Vector2u& cell,
+        sf::Uint8 flags) const;
 
     ///////////////////////////////////////////////////////////////////////////
     ///
     ///////////////////////////////////////////////////////////////////////////
-    void updateForegroundPosition(const sf::Vector2u& coords,
-        const sf::IntRect& textureRect, const sf::Vector2i& offset);
+    void updateRows(sf::Uint32 top, sf::Uint32 bottom,
+        sf::Vector2u& overhang) const;
 
     ///////////////////////////////////////////////////////////////////////////
     ///
     ///////////////////////////////////////////////////////////////////////////
-    void updateForegroundColor(const sf::Vector2u& coords,
-        const sf::Color& color);
+    sf::Uint32 updateRun(sf::Uint32 index, sf::Uint32 count,
+        const sf::Vector2u& cell, bool loadGlyphs,
+        sf::Vector2u& overhang) const;
 
     ///////////////////////////////////////////////////////////////////////////
     ///
-    /////////////////////////////////////////////////////////////////////////// 
-    void updateBackgroundPosition(const sf::Vector2u& coords);
+    ///////////////////////////////////////////////////////////////////////////
+    static void writeForegroundQuad(sf::Vertex* quad, float x, float y,
+        const sf::IntRect& textureRect);
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static void writeBackgroundQuad(sf::Vertex* quad, float x, float y,
+        float width, float height);
 
     ///////////////////////////////////////////////////////////////////////////
     ///
     ///////////////////////////////////////////////////////////////////////////
-    void updateBackgroundColor(const sf::Vector2u& coords,
-        const sf::Color& color);
+    static void writeQuadColor(sf::Vertex* quad, const sf::Color& color);
 
     ///////////////////////////////////////////////////////////////////////////
-    sf::Font& m_font;
+    std::shared_ptr<GlyphCache> m_glyphCache;
     sf::Vector2u m_area;
     sf::Vector2u m_spacing;
-    sf::Uint32 m_characterSize;
-    sf::VertexArray m_foreground;
-    sf::VertexArray m_background;
+    sf::Vector2u m_origin;
+    sf::Vector2i m_scroll;
+    std::vector<PackedTile> m_tiles;
+    bool m_deferred;
+    mutable std::vector<sf::Uint8> m_dirtyTiles;
+    mutable std::vector<sf::Uint8> m_dirtyRows;
+    mutable bool m_dirty;
+    mutable std::vector<sf::Vertex> m_foreground;
+    mutable std::vector<sf::Uint32> m_quads;
+    mutable std::vector<sf::Uint32> m_quadTiles;
+    mutable std::vector<sf::Color> m_background;
+    std::vector<sf::Color> m_light;
+    mutable sf::Texture m_backgroundTexture;
+    mutable sf::Uint32 m_backgroundDirtyTop;
+    mutable sf::Uint32 m_backgroundDirtyBottom;
+    mutable sf::Uint32 m_visibleBackgrounds;
+    mutable std::vector<sf::Uint32> m_visibleBackgroundRows;
+    mutable sf::Uint32 m_culledQuads;
+    mutable FrameStats m_stats;
+    sf::Vertex m_backgroundQuad[4];
+    std::unique_ptr<sf::RenderTexture> m_cache;
+    sf::Vertex m_cacheQuad[4];
+    mutable sf::Uint32 m_cacheDirtyTop;
+    mutable sf::Uint32 m_cacheDirtyBottom;
+    mutable sf::Vector2u m_overhang;
+    GlyphTileRecorder* m_recorder;
 };
 
 #endif
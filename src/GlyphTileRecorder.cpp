@@ -0,0 +1,615 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       GlyphTileRecorder.cpp
+/// License:        MIT
+/// Description:    Records the tiles of a GlyphTileMap that change each frame
+///                 into a compact stream of deltas, and plays such a stream
+///                 back into another GlyphTileMap.
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GlyphTileRecorder.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// A frame is its size in bytes followed by the scroll offset and then, for
+/// each channel, a count of Ops and the Ops themselves. Every number is a
+/// LEB128 varint (zigzagged if signed), and an Op is its x, its y less the
+/// previous Op's, its width, its height * 2 + fill and then its values.
+///
+/// A character value is a varint of codepoint * 8 + type * 2 + hasOffset,
+/// followed by the two offset bytes if hasOffset is set. A color value is
+/// its four bytes.
+///////////////////////////////////////////////////////////////////////////////
+const sf::Uint32 NoOp = 0xFFFFFFFF;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Ops with this many equal values or more are stored as fills.
+///////////////////////////////////////////////////////////////////////////////
+const sf::Uint32 MinFillWidth = 2;
+
+///////////////////////////////////////////////////////////////////////////////
+void writeVarint(std::vector<sf::Uint8>& stream, sf::Uint32 value)
+{
+    while (value >= 0x80) {
+        stream.push_back(static_cast<sf::Uint8>(value | 0x80));
+        value >>= 7;
+    }
+
+    stream.push_back(static_cast<sf::Uint8>(value));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void writeSigned(std::vector<sf::Uint8>& stream, sf::Int32 value)
+{
+    writeVarint(stream, (static_cast<sf::Uint32>(value) << 1)
+        ^ static_cast<sf::Uint32>(value >> 31));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Packs the part of a Tile that a channel holds into one comparable value.
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint64 getChannelValue(const GlyphTileMap::Tile& tile,
+    sf::Uint32 channel)
+{
+    switch (channel) {
+    case 0:
+        return static_cast<sf::Uint32>(tile.character)
+            | (static_cast<sf::Uint64>(tile.type) << 21)
+            | (static_cast<sf::Uint64>(static_cast<sf::Uint8>(
+                tile.offset.x)) << 23)
+            | (static_cast<sf::Uint64>(static_cast<sf::Uint8>(
+                tile.offset.y)) << 31);
+    case 1:
+        return tile.foreground.toInteger();
+    default:
+        return tile.background.toInteger();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void writeChannelValue(std::vector<sf::Uint8>& stream, sf::Uint32 channel,
+    sf::Uint64 value)
+{
+    if (channel == 0) {
+        sf::Uint32 codepoint = value & 0x1FFFFF;
+        sf::Uint32 type = (value >> 21) & 0x3;
+        sf::Uint8 x = static_cast<sf::Uint8>(value >> 23);
+        sf::Uint8 y = static_cast<sf::Uint8>(value >> 31);
+        bool hasOffset = x != 0 || y != 0;
+
+        writeVarint(stream, (codepoint << 3) | (type << 1)
+            | (hasOffset ? 1 : 0));
+
+        if (hasOffset) {
+            stream.push_back(x);
+            stream.push_back(y);
+        }
+    } else {
+        sf::Uint32 color = static_cast<sf::Uint32>(value);
+
+        stream.push_back(static_cast<sf::Uint8>(color >> 24));
+        stream.push_back(static_cast<sf::Uint8>(color >> 16));
+        stream.push_back(static_cast<sf::Uint8>(color >> 8));
+        stream.push_back(static_cast<sf::Uint8>(color));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Reads a stream without running past its end.
+///////////////////////////////////////////////////////////////////////////////
+struct Reader {
+    bool readByte(sf::Uint8& value)
+    {
+        if (position == end) {
+            return false;
+        }
+
+        value = *position++;
+
+        return true;
+    }
+
+    bool readVarint(sf::Uint32& value)
+    {
+        value = 0;
+
+        for (sf::Uint32 shift = 0; shift < 35; shift += 7) {
+            sf::Uint8 byte;
+
+            if (!readByte(byte)) {
+                return false;
+            }
+
+            value |= static_cast<sf::Uint32>(byte & 0x7F) << shift;
+
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool readSigned(sf::Int32& value)
+    {
+        sf::Uint32 zigzag;
+
+        if (!readVarint(zigzag)) {
+            return false;
+        }
+
+        value = static_cast<sf::Int32>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+
+        return true;
+    }
+
+    const sf::Uint8* position;
+    const sf::Uint8* end;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// Reads a channel value into the part of a Tile it describes.
+///////////////////////////////////////////////////////////////////////////////
+bool readChannelValue(Reader& reader, sf::Uint32 channel,
+    GlyphTileMap::Tile& tile)
+{
+    if (channel == 0) {
+        sf::Uint32 value;
+        sf::Uint8 x = 0;
+        sf::Uint8 y = 0;
+
+        if (!reader.readVarint(value)) {
+            return false;
+        }
+
+        if ((value & 1) && (!reader.readByte(x) || !reader.readByte(y))) {
+            return false;
+        }
+
+        tile.character = static_cast<wchar_t>(value >> 3);
+        tile.type = static_cast<GlyphTileMap::Tile::Type>((value >> 1) & 0x3);
+        tile.offset = {static_cast<sf::Int8>(x), static_cast<sf::Int8>(y)};
+    } else {
+        sf::Uint8 rgba[4];
+
+        for (sf::Uint8& component : rgba) {
+            if (!reader.readByte(component)) {
+                return false;
+            }
+        }
+
+        sf::Color& color = (channel == 1) ? tile.foreground : tile.background;
+        color = sf::Color(rgba[0], rgba[1], rgba[2], rgba[3]);
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool playChannel(Reader& reader, sf::Uint32 channel, GlyphTileMap& tileMap)
+{
+    const sf::Vector2u& area = tileMap.getArea();
+    GlyphTileMap::Tile tile;
+    sf::Uint32 count;
+    sf::Uint32 y = 0;
+
+    if (!reader.readVarint(count)) {
+        return false;
+    }
+
+    for (sf::Uint32 i = 0; i < count; ++i) {
+        sf::Uint32 x, dy, width, kind;
+
+        if (!reader.readVarint(x) || !reader.readVarint(dy)
+            || !reader.readVarint(width) || !reader.readVarint(kind)) {
+            return false;
+        }
+
+        y += dy;
+
+        if (kind & 1) {
+            if (!readChannelValue(reader, channel, tile)) {
+                return false;
+            }
+
+            sf::Vector2u size(width, kind >> 1);
+
+            if (channel == 0) {
+                tileMap.fillTileCharacter({x, y}, size, tile.character,
+                    tile.type, tile.offset);
+            } else if (channel == 1) {
+                tileMap.fillTileForeground({x, y}, size, tile.foreground);
+            } else {
+                tileMap.fillTileBackground({x, y}, size, tile.background);
+            }
+
+            continue;
+        }
+
+        for (sf::Uint32 j = 0; j < width; ++j) {
+            if (!readChannelValue(reader, channel, tile)) {
+                return false;
+            }
+
+            if (x >= area.x || j >= area.x - x || y >= area.y) {
+                continue;
+            }
+
+            sf::Vector2u coords(x + j, y);
+
+            if (channel == 0) {
+                tileMap.setTileCharacter(coords, tile.character, tile.type,
+                    tile.offset);
+            } else if (channel == 1) {
+                tileMap.setTileForeground(coords, tile.foreground);
+            } else {
+                tileMap.setTileBackground(coords, tile.background);
+            }
+        }
+    }
+
+    return true;
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+GlyphTileRecorder::GlyphTileRecorder(const sf::Vector2u& area)
+    : m_area(area)
+    , m_origin(0, 0)
+    , m_scroll(0, 0)
+    , m_marks(area.x * area.y, 0)
+    , m_markedRows(area.y, 0)
+    , m_rowMarks(area.x, 0)
+    , m_rowValues()
+    , m_channels()
+    , m_frame()
+    , m_stream()
+    , m_frameCount(0)
+{
+    for (std::vector<sf::Uint64>& values : m_rowValues) {
+        values.resize(area.x);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Vector2u& GlyphTileRecorder::getArea() const
+{
+    return m_area;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileRecorder::markTiles(const sf::Vector2u& coords,
+    const sf::Vector2u& area, sf::Uint8 channels)
+{
+    if (coords.x >= m_area.x || coords.y >= m_area.y) {
+        return;
+    }
+
+    // Marks are kept where the tiles are stored in a ring like the map's, so
+    // scrolling never has to move them.
+    sf::Uint32 width = std::min(area.x, m_area.x - coords.x);
+    sf::Uint32 height = std::min(area.y, m_area.y - coords.y);
+    sf::Uint32 x = coords.x + m_origin.x;
+
+    if (x >= m_area.x) {
+        x -= m_area.x;
+    }
+
+    if (width == 1 && height == 1) {
+        sf::Uint32 y = coords.y + m_origin.y;
+
+        if (y >= m_area.y) {
+            y -= m_area.y;
+        }
+
+        m_marks[(y * m_area.x) + x] |= channels;
+        m_markedRows[y] = 1;
+        return;
+    }
+
+    sf::Uint32 count = std::min(width, m_area.x - x);
+
+    for (sf::Uint32 i = 0; i < height; ++i) {
+        sf::Uint32 y = coords.y + i + m_origin.y;
+
+        if (y >= m_area.y) {
+            y -= m_area.y;
+        }
+
+        sf::Uint8* row = &m_marks[y * m_area.x];
+
+        for (sf::Uint32 j = 0; j < count; ++j) {
+            row[x + j] |= channels;
+        }
+        for (sf::Uint32 j = 0; j < width - count; ++j) {
+            row[j] |= channels;
+        }
+
+        m_markedRows[y] = 1;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileRecorder::markScroll(sf::Int32 dx, sf::Int32 dy)
+{
+    sf::Int32 width = static_cast<sf::Int32>(m_area.x);
+    sf::Int32 height = static_cast<sf::Int32>(m_area.y);
+
+    if (width == 0 || height == 0) {
+        return;
+    }
+
+    m_scroll.x += dx;
+    m_scroll.y += dy;
+    m_origin.x = (m_origin.x + static_cast<sf::Uint32>(((dx % width) + width)
+        % width)) % m_area.x;
+    m_origin.y = (m_origin.y + static_cast<sf::Uint32>(((dy % height)
+        + height) % height)) % m_area.y;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileRecorder::recordFrame(const GlyphTileMap& tileMap)
+{
+    m_frame.clear();
+    writeSigned(m_frame, m_scroll.x);
+    writeSigned(m_frame, m_scroll.y);
+    m_scroll = {0, 0};
+
+    for (ChannelOps& channel : m_channels) {
+        channel.ops.clear();
+        channel.values.clear();
+        channel.previousFills.clear();
+    }
+
+    for (sf::Uint32 y = 0; y < m_area.y; ++y) {
+        sf::Uint32 cellY = y + m_origin.y;
+
+        if (cellY >= m_area.y) {
+            cellY -= m_area.y;
+        }
+
+        if (!m_markedRows[cellY]) {
+            for (ChannelOps& channel : m_channels) {
+                channel.previousFills.clear();
+            }
+            continue;
+        }
+
+        // Read the marked tiles of the row in map order, so each channel's
+        // runs can be found in one pass.
+        sf::Uint8* row = &m_marks[cellY * m_area.x];
+
+        for (sf::Uint32 x = 0; x < m_area.x; ++x) {
+            sf::Uint32 cellX = x + m_origin.x;
+
+            if (cellX >= m_area.x) {
+                cellX -= m_area.x;
+            }
+
+            sf::Uint8 marks = row[cellX];
+            m_rowMarks[x] = marks;
+
+            if (!marks) {
+                continue;
+            }
+
+            GlyphTileMap::Tile tile = tileMap.getTile({x, y});
+
+            for (sf::Uint32 channel = 0; channel < 3; ++channel) {
+                if (marks & (1 << channel)) {
+                    m_rowValues[channel][x] = getChannelValue(tile, channel);
+                }
+            }
+        }
+
+        std::fill(row, row + m_area.x, 0);
+        m_markedRows[cellY] = 0;
+
+        for (sf::Uint32 channel = 0; channel < 3; ++channel) {
+            encodeRow(channel, y, m_rowMarks.data());
+        }
+    }
+
+    for (sf::Uint32 channel = 0; channel < 3; ++channel) {
+        writeChannel(channel);
+    }
+
+    writeVarint(m_stream, static_cast<sf::Uint32>(m_frame.size()));
+    m_stream.insert(m_stream.end(), m_frame.begin(), m_frame.end());
+    ++m_frameCount;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const std::vector<sf::Uint8>& GlyphTileRecorder::getStream() const
+{
+    return m_stream;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 GlyphTileRecorder::getFrameCount() const
+{
+    return m_frameCount;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileRecorder::clear()
+{
+    m_stream.clear();
+    m_frameCount = 0;
+    m_scroll = {0, 0};
+    std::fill(m_marks.begin(), m_marks.end(), AllChannels);
+    std::fill(m_markedRows.begin(), m_markedRows.end(), 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileRecorder::encodeRow(sf::Uint32 channel, sf::Uint32 y,
+    const sf::Uint8* marks)
+{
+    ChannelOps& ops = m_channels[channel];
+    const std::vector<sf::Uint64>& values = m_rowValues[channel];
+    sf::Uint8 bit = static_cast<sf::Uint8>(1 << channel);
+    sf::Uint32 above = 0;
+    sf::Uint32 literal = NoOp;
+
+    for (sf::Uint32 x = 0; x < m_area.x;) {
+        if (!(marks[x] & bit)) {
+            literal = NoOp;
+            ++x;
+            continue;
+        }
+
+        sf::Uint64 value = values[x];
+        sf::Uint32 end = x + 1;
+
+        while (end < m_area.x && (marks[end] & bit) && values[end] == value) {
+            ++end;
+        }
+
+        // A run exactly below an equal fill on the previous row extends it
+        // downwards instead of starting an Op of its own.
+        while (above < ops.previousFills.size()
+            && ops.ops[ops.previousFills[above]].x < x) {
+            ++above;
+        }
+
+        if (above < ops.previousFills.size()) {
+            Op& fill = ops.ops[ops.previousFills[above]];
+
+            if (fill.x == x && fill.width == end - x
+                && ops.values[fill.value] == value) {
+                ++fill.height;
+                ops.currentFills.push_back(ops.previousFills[above]);
+                literal = NoOp;
+                x = end;
+                continue;
+            }
+        }
+
+        if (end - x >= MinFillWidth) {
+            Op fill = {x, y, end - x, 1, true,
+                static_cast<sf::Uint32>(ops.values.size())};
+
+            ops.currentFills.push_back(static_cast<sf::Uint32>(
+                ops.ops.size()));
+            ops.ops.push_back(fill);
+            ops.values.push_back(value);
+            literal = NoOp;
+        } else {
+            if (literal == NoOp) {
+                Op run = {x, y, 0, 1, false,
+                    static_cast<sf::Uint32>(ops.values.size())};
+
+                literal = static_cast<sf::Uint32>(ops.ops.size());
+                ops.ops.push_back(run);
+            }
+
+            ops.values.push_back(value);
+            ++ops.ops[literal].width;
+        }
+
+        x = end;
+    }
+
+    std::swap(ops.previousFills, ops.currentFills);
+    ops.currentFills.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTileRecorder::writeChannel(sf::Uint32 channel)
+{
+    const ChannelOps& ops = m_channels[channel];
+    sf::Uint32 y = 0;
+
+    writeVarint(m_frame, static_cast<sf::Uint32>(ops.ops.size()));
+
+    for (const Op& op : ops.ops) {
+        writeVarint(m_frame, op.x);
+        writeVarint(m_frame, op.y - y);
+        writeVarint(m_frame, op.width);
+        writeVarint(m_frame, (op.height << 1) | (op.fill ? 1 : 0));
+        y = op.y;
+
+        sf::Uint32 count = op.fill ? 1 : op.width;
+
+        for (sf::Uint32 i = 0; i < count; ++i) {
+            writeChannelValue(m_frame, channel, ops.values[op.value + i]);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+GlyphTilePlayer::GlyphTilePlayer(const sf::Uint8* data, std::size_t size)
+    : m_data(data)
+    , m_size(size)
+    , m_position(0)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+bool GlyphTilePlayer::playFrame(GlyphTileMap& tileMap)
+{
+    if (m_position >= m_size) {
+        return false;
+    }
+
+    Reader reader = {m_data + m_position, m_data + m_size};
+    sf::Uint32 size;
+
+    if (!reader.readVarint(size)
+        || size > static_cast<std::size_t>(reader.end - reader.position)) {
+        m_position = m_size;
+        return false;
+    }
+
+    Reader frame = {reader.position, reader.position + size};
+    m_position = static_cast<std::size_t>(frame.end - m_data);
+
+    sf::Int32 dx, dy;
+
+    if (!frame.readSigned(dx) || !frame.readSigned(dy)) {
+        m_position = m_size;
+        return false;
+    }
+
+    // Every tile the frame touches is rebuilt once, when deferral ends.
+    bool deferred = tileMap.isDeferred();
+    bool played = true;
+    tileMap.setDeferred(true);
+
+    if (dx != 0 || dy != 0) {
+        tileMap.scroll(dx, dy);
+    }
+
+    for (sf::Uint32 channel = 0; channel < 3 && played; ++channel) {
+        played = playChannel(frame, channel, tileMap);
+    }
+
+    tileMap.setDeferred(deferred);
+
+    if (!played) {
+        m_position = m_size;
+    }
+
+    return played;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool GlyphTilePlayer::isFinished() const
+{
+    return m_position >= m_size;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GlyphTilePlayer::rewind()
+{
+    m_position = 0;
+}
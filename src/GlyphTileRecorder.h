@@ -0,0 +1,226 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       GlyphTileRecorder.h
+/// License:        MIT
+/// Description:    Records the tiles of a GlyphTileMap that change each frame
+///                 into a compact stream of deltas, and plays such a stream
+///                 back into another GlyphTileMap.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef GLYPH_TILE_RECORDER_H
+#define GLYPH_TILE_RECORDER_H
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef>
+#include <vector>
+
+#include <SFML/System.hpp>
+#include <SFML/Graphics.hpp>
+
+#include "GlyphTileMap.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// A GlyphTileRecorder attached to a GlyphTileMap with setRecorder() is told
+/// which tiles every setter touches, which costs the setters no more than
+/// setting a byte per tile. Once per frame, recordFrame() reads the final
+/// state of the touched tiles and appends one frame to the stream.
+///
+/// Frames keep characters, foregrounds and backgrounds in separate channels,
+/// so a frame that only recolors tiles stores no characters. Within each
+/// channel, runs of equal values are stored once and stacked into
+/// rectangles, and scrolling is stored as a single offset. A frame in which
+/// nothing changed takes a few bytes.
+///
+/// The first frame recorded after setRecorder() or clear() holds every tile,
+/// so a stream can be played back into any map of the same area.
+///////////////////////////////////////////////////////////////////////////////
+class GlyphTileRecorder : sf::NonCopyable {
+public:
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// Channels name the parts of a tile that a change touched, as set by
+    /// setTileCharacter, setTileForeground and setTileBackground.
+    ///////////////////////////////////////////////////////////////////////////
+    enum Channel : sf::Uint8 {
+        CharacterChannel = 1 << 0,
+        ForegroundChannel = 1 << 1,
+        BackgroundChannel = 1 << 2,
+        AllChannels = CharacterChannel | ForegroundChannel | BackgroundChannel
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor
+    ///
+    /// \param area     Width and height of the recorded GlyphTileMap in # of
+    ///                 tiles
+    ///////////////////////////////////////////////////////////////////////////
+    explicit GlyphTileRecorder(const sf::Vector2u& area);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a const reference to the area of the recorded grid
+    ///
+    /// \return a const reference to the area of the recorded grid in tiles
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Vector2u& getArea() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Marks a rectangle of tiles as changed this frame
+    ///
+    /// Called by the GlyphTileMap the recorder is attached to.
+    ///
+    /// \param coords   Coordinates of the top left tile of the rectangle
+    /// \param area     Width and height of the rectangle in # of tiles
+    /// \param channels Channels that changed
+    ///////////////////////////////////////////////////////////////////////////
+    void markTiles(const sf::Vector2u& coords, const sf::Vector2u& area,
+        sf::Uint8 channels);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Records a scroll of the whole grid
+    ///
+    /// Called by the GlyphTileMap the recorder is attached to, before it
+    /// marks the tiles the scroll exposed.
+    ///
+    /// \param dx   Number of tiles scrolled horizontally
+    /// \param dy   Number of tiles scrolled vertically
+    ///////////////////////////////////////////////////////////////////////////
+    void markScroll(sf::Int32 dx, sf::Int32 dy);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Appends the changes made since the last frame to the stream
+    ///
+    /// \param tileMap  GlyphTileMap the recorder is attached to
+    ///////////////////////////////////////////////////////////////////////////
+    void recordFrame(const GlyphTileMap& tileMap);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the recorded stream
+    ///
+    /// The stream is a sequence of frames with no header, made only of bytes,
+    /// so it reads back the same on any machine.
+    ///
+    /// \return a const reference to the bytes recorded so far
+    ///////////////////////////////////////////////////////////////////////////
+    const std::vector<sf::Uint8>& getStream() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of frames in the stream
+    ///
+    /// \return the number of frames recorded since the last clear()
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint32 getFrameCount() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Discards the recorded stream
+    ///
+    /// Every tile is marked, so the next frame starts a new stream that can
+    /// be played on its own.
+    ///////////////////////////////////////////////////////////////////////////
+    void clear();
+
+private:
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// Op sets a rectangle of one channel: to a single value if fill is set,
+    /// or else a row of width values starting at values[value].
+    ///////////////////////////////////////////////////////////////////////////
+    struct Op {
+        sf::Uint32 x;
+        sf::Uint32 y;
+        sf::Uint32 width;
+        sf::Uint32 height;
+        bool fill;
+        sf::Uint32 value;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// ChannelOps collects the Ops of one channel while a frame is encoded.
+    /// Fills ending on the previous row are kept so equal fills below them
+    /// extend them into rectangles.
+    ///////////////////////////////////////////////////////////////////////////
+    struct ChannelOps {
+        std::vector<Op> ops;
+        std::vector<sf::Uint64> values;
+        std::vector<sf::Uint32> previousFills;
+        std::vector<sf::Uint32> currentFills;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void encodeRow(sf::Uint32 channel, sf::Uint32 y, const sf::Uint8* marks);
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void writeChannel(sf::Uint32 channel);
+
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Vector2u m_area;
+    sf::Vector2u m_origin;
+    sf::Vector2i m_scroll;
+    std::vector<sf::Uint8> m_marks;
+    std::vector<sf::Uint8> m_markedRows;
+    std::vector<sf::Uint8> m_rowMarks;
+    std::vector<sf::Uint64> m_rowValues[3];
+    ChannelOps m_channels[3];
+    std::vector<sf::Uint8> m_frame;
+    std::vector<sf::Uint8> m_stream;
+    sf::Uint32 m_frameCount;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// A GlyphTilePlayer plays a stream recorded by a GlyphTileRecorder into a
+/// GlyphTileMap one frame at a time. Each frame is applied with the map's
+/// bulk fills where the recorder found runs, and with vertex generation
+/// deferred, so every changed tile is rebuilt once per frame.
+///////////////////////////////////////////////////////////////////////////////
+class GlyphTilePlayer {
+public:
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor
+    ///
+    /// \param data     First byte of the stream, which must outlive the
+    ///                 GlyphTilePlayer
+    /// \param size     Size of the stream in bytes
+    ///////////////////////////////////////////////////////////////////////////
+    GlyphTilePlayer(const sf::Uint8* data, std::size_t size);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Applies the next frame of the stream to a GlyphTileMap
+    ///
+    /// The map should have the area the stream was recorded with. A frame
+    /// that is cut short or damaged ends playback and may be applied only in
+    /// part.
+    ///
+    /// \param tileMap  GlyphTileMap to apply the frame to
+    ///
+    /// \return true if a frame was applied, false at the end of the stream
+    ///////////////////////////////////////////////////////////////////////////
+    bool playFrame(GlyphTileMap& tileMap);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns whether every frame has been played
+    ///
+    /// \return true at the end of the stream
+    ///////////////////////////////////////////////////////////////////////////
+    bool isFinished() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns to the first frame of the stream
+    ///////////////////////////////////////////////////////////////////////////
+    void rewind();
+
+private:
+
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Uint8* m_data;
+    std::size_t m_size;
+    std::size_t m_position;
+};
+
+#endif
@@ -0,0 +1,349 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       LayeredGlyphTileMap.cpp
+/// License:        MIT
+/// Description:    Several layers of tiles over one grid, drawn bottom to top
+///                 with a single draw call.
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LayeredGlyphTileMap.h"
+
+#include <algorithm>
+
+namespace
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// Backgrounds are drawn with the glyph atlas bound, sampling the white
+/// texels sf::Font keeps at its top left corner (as sf::Text's underlines do).
+///////////////////////////////////////////////////////////////////////////////
+const sf::FloatRect WhiteTexel(1.f, 1.f, 0.f, 0.f);
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+LayeredGlyphTileMap::LayeredGlyphTileMap(sf::Font& font,
+    const sf::Vector2u& area, const sf::Vector2u& spacing,
+    sf::Uint32 characterSize, sf::Uint32 layerCount)
+    : m_glyphCache(font, characterSize, spacing)
+    , m_area(area)
+    , m_spacing(spacing)
+    , m_layers(layerCount)
+    , m_blank(L' ', Tile::Center, sf::Color::White, sf::Color::Transparent)
+    , m_dirty(false)
+    , m_dirtyRows(area.y, 0)
+    , m_rowVertices(layerCount * 2 * area.y)
+    , m_rowOffsets(layerCount * 2 * area.y, 0)
+    , m_vertices()
+    , m_baseLayers(area.x * area.y, 0)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+LayeredGlyphTileMap::LayeredGlyphTileMap(const BakedGlyphAtlas& atlas,
+    const sf::Vector2u& area, const sf::Vector2u& spacing,
+    sf::Uint32 layerCount)
+    : m_glyphCache(atlas, spacing)
+    , m_area(area)
+    , m_spacing(spacing)
+    , m_layers(layerCount)
+    , m_blank(L' ', Tile::Center, sf::Color::White, sf::Color::Transparent)
+    , m_dirty(false)
+    , m_dirtyRows(area.y, 0)
+    , m_rowVertices(layerCount * 2 * area.y)
+    , m_rowOffsets(layerCount * 2 * area.y, 0)
+    , m_vertices()
+    , m_baseLayers(area.x * area.y, 0)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Vector2u& LayeredGlyphTileMap::getArea() const
+{
+    return m_area;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Vector2u& LayeredGlyphTileMap::getSpacing() const
+{
+    return m_spacing;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 LayeredGlyphTileMap::getCharacterSize() const
+{
+    return m_glyphCache.getCharacterSize();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 LayeredGlyphTileMap::getLayerCount() const
+{
+    return static_cast<sf::Uint32>(m_layers.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Uint32 LayeredGlyphTileMap::getQuadCount() const
+{
+    ensureVerticesUpdate();
+
+    return static_cast<sf::Uint32>(m_vertices.size() / 4);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+LayeredGlyphTileMap::Tile LayeredGlyphTileMap::getTile(sf::Uint32 layer,
+    const sf::Vector2u& coords) const
+{
+    const std::vector<Tile>& tiles = m_layers[layer];
+
+    return tiles.empty() ? m_blank : tiles[(coords.y * m_area.x) + coords.x];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LayeredGlyphTileMap::setTile(sf::Uint32 layer, const sf::Vector2u& coords,
+    const Tile& tile)
+{
+    getLayerTile(layer, coords) = tile;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LayeredGlyphTileMap::setTileCharacter(sf::Uint32 layer,
+    const sf::Vector2u& coords, wchar_t character, Tile::Type type,
+    const sf::Vector2i& offset)
+{
+    Tile& tile = getLayerTile(layer, coords);
+
+    tile.character = character;
+    tile.type = type;
+    tile.offset = offset;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LayeredGlyphTileMap::setTileForeground(sf::Uint32 layer,
+    const sf::Vector2u& coords, const sf::Color& color)
+{
+    getLayerTile(layer, coords).foreground = color;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LayeredGlyphTileMap::setTileBackground(sf::Uint32 layer,
+    const sf::Vector2u& coords, const sf::Color& color)
+{
+    getLayerTile(layer, coords).background = color;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LayeredGlyphTileMap::fillTiles(sf::Uint32 layer,
+    const sf::Vector2u& coords, const sf::Vector2u& area, const Tile& tile)
+{
+    if (coords.x >= m_area.x || coords.y >= m_area.y) {
+        return;
+    }
+
+    sf::Vector2u end(std::min(coords.x + area.x, m_area.x),
+        std::min(coords.y + area.y, m_area.y));
+
+    for (sf::Uint32 y = coords.y; y < end.y; ++y) {
+        Tile* row = &getLayerTile(layer, {0, y});
+        std::fill(row + coords.x, row + end.x, tile);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LayeredGlyphTileMap::clearLayer(sf::Uint32 layer)
+{
+    std::vector<Tile>& tiles = m_layers[layer];
+
+    if (tiles.empty()) {
+        return;
+    }
+
+    std::vector<Tile>().swap(tiles);
+    std::fill(m_dirtyRows.begin(), m_dirtyRows.end(), 1);
+    m_dirty = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LayeredGlyphTileMap::draw(sf::RenderTarget& target,
+    sf::RenderStates states) const
+{
+    ensureVerticesUpdate();
+
+    if (m_vertices.empty()) {
+        return;
+    }
+
+    states.transform *= getTransform();
+    states.texture = &m_glyphCache.getTexture();
+    target.draw(m_vertices.data(), m_vertices.size(), sf::Quads, states);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+LayeredGlyphTileMap::Tile& LayeredGlyphTileMap::getLayerTile(
+    sf::Uint32 layer, const sf::Vector2u& coords)
+{
+    std::vector<Tile>& tiles = m_layers[layer];
+
+    if (tiles.empty()) {
+        tiles.assign(m_area.x * m_area.y, m_blank);
+    }
+
+    m_dirtyRows[coords.y] = 1;
+    m_dirty = true;
+
+    return tiles[(coords.y * m_area.x) + coords.x];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LayeredGlyphTileMap::ensureVerticesUpdate() const
+{
+    if (!m_dirty) {
+        return;
+    }
+
+    m_dirty = false;
+
+    // Only rows with changed tiles are emitted again. While no row changes
+    // its number of quads, they are copied over their old vertices in place;
+    // otherwise the vertices are gathered again from every row.
+    bool resized = false;
+
+    for (sf::Uint32 y = 0; y < m_area.y; ++y) {
+        if (!m_dirtyRows[y]) {
+            continue;
+        }
+
+        m_dirtyRows[y] = 0;
+
+        // Nothing beneath the topmost opaque background of a tile can be
+        // seen.
+        sf::Uint32 begin = y * m_area.x;
+        sf::Uint32 end = begin + m_area.x;
+
+        std::fill(m_baseLayers.begin() + begin, m_baseLayers.begin() + end,
+            0);
+
+        for (sf::Uint32 layer = 0; layer < m_layers.size(); ++layer) {
+            const std::vector<Tile>& tiles = m_layers[layer];
+
+            if (tiles.empty()) {
+                continue;
+            }
+
+            for (sf::Uint32 index = begin; index < end; ++index) {
+                if (tiles[index].background.a == 255) {
+                    m_baseLayers[index] = layer;
+                }
+            }
+        }
+
+        for (sf::Uint32 layer = 0; layer < m_layers.size(); ++layer)
+        for (sf::Uint32 pass = 0; pass < 2; ++pass) {
+            sf::Uint32 row = ((layer * 2) + pass) * m_area.y + y;
+            std::vector<sf::Vertex>& vertices = m_rowVertices[row];
+            std::size_t count = vertices.size();
+
+            updateRow(layer, pass == 1, y, vertices);
+
+            if (vertices.size() != count) {
+                resized = true;
+            } else if (!resized) {
+                std::copy(vertices.begin(), vertices.end(),
+                    m_vertices.begin() + m_rowOffsets[row]);
+            }
+        }
+    }
+
+    if (!resized) {
+        return;
+    }
+
+    m_vertices.clear();
+
+    for (sf::Uint32 row = 0; row < m_rowVertices.size(); ++row) {
+        m_rowOffsets[row] = static_cast<sf::Uint32>(m_vertices.size());
+        m_vertices.insert(m_vertices.end(), m_rowVertices[row].begin(),
+            m_rowVertices[row].end());
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LayeredGlyphTileMap::updateRow(sf::Uint32 layer, bool foreground,
+    sf::Uint32 y, std::vector<sf::Vertex>& vertices) const
+{
+    vertices.clear();
+
+    const std::vector<Tile>& tiles = m_layers[layer];
+
+    if (tiles.empty()) {
+        return;
+    }
+
+    // Each layer emits its backgrounds and then its foregrounds, the same
+    // order separate GlyphTileMaps drawn one after another would produce.
+    float width = static_cast<float>(m_spacing.x);
+    float height = static_cast<float>(m_spacing.y);
+    sf::Uint32 begin = y * m_area.x;
+
+    if (!foreground) {
+        for (sf::Uint32 x = 0, index = begin; x < m_area.x; ++x, ++index) {
+            const Tile& tile = tiles[index];
+
+            if (tile.background.a > 0 && layer >= m_baseLayers[index]) {
+                appendQuad(vertices, x * width, y * height, width, height,
+                    WhiteTexel, tile.background);
+            }
+        }
+
+        return;
+    }
+
+    for (sf::Uint32 x = 0, index = begin; x < m_area.x; ++x, ++index) {
+        const Tile& tile = tiles[index];
+
+        if (tile.foreground.a == 0) {
+            continue;
+        }
+
+        const GlyphCache::Glyph& glyph = m_glyphCache.get(
+            static_cast<sf::Uint32>(tile.character));
+        const sf::IntRect& rect = glyph.textureRect;
+
+        if (rect.width <= 0 || rect.height <= 0) {
+            continue;
+        }
+
+        sf::Vector2i offset = GlyphTileMap::getAdjustedOffset(glyph,
+            tile.type, tile.offset);
+
+        // Glyphs hanging over the edge of a covered tile still show.
+        if (layer < m_baseLayers[index] && offset.x >= 0 && offset.y >= 0
+            && offset.x + rect.width <= static_cast<int>(m_spacing.x)
+            && offset.y + rect.height <= static_cast<int>(m_spacing.y)) {
+            continue;
+        }
+
+        appendQuad(vertices, x * width + offset.x, y * height + offset.y,
+            static_cast<float>(rect.width), static_cast<float>(rect.height),
+            sf::FloatRect(rect), tile.foreground);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LayeredGlyphTileMap::appendQuad(std::vector<sf::Vertex>& vertices,
+    float x, float y, float width, float height,
+    const sf::FloatRect& textureRect, const sf::Color& color)
+{
+    float right = textureRect.left + textureRect.width;
+    float bottom = textureRect.top + textureRect.height;
+
+    vertices.emplace_back(sf::Vector2f(x, y), color,
+        sf::Vector2f(textureRect.left, textureRect.top));
+    vertices.emplace_back(sf::Vector2f(x + width, y), color,
+        sf::Vector2f(right, textureRect.top));
+    vertices.emplace_back(sf::Vector2f(x + width, y + height), color,
+        sf::Vector2f(right, bottom));
+    vertices.emplace_back(sf::Vector2f(x, y + height), color,
+        sf::Vector2f(textureRect.left, bottom));
+}
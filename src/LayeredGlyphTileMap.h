@@ -0,0 +1,216 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       LayeredGlyphTileMap.h
+/// License:        MIT
+/// Description:    Several layers of tiles over one grid, drawn bottom to top
+///                 with a single draw call.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef LAYERED_GLYPH_TILE_MAP_H
+#define LAYERED_GLYPH_TILE_MAP_H
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include <vector>
+
+#include <SFML/System.hpp>
+#include <SFML/Graphics.hpp>
+
+#include "GlyphCache.h"
+#include "GlyphTileMap.h"
+
+class LayeredGlyphTileMap : public sf::Drawable, public sf::Transformable {
+public:
+
+    typedef GlyphTileMap::Tile Tile;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor
+    ///
+    /// Layers own no storage until one of their tiles is set; until then all
+    /// of their tiles are blank Tiles (L' ', Center, White foreground,
+    /// Transparent background).
+    ///
+    /// \param font             Reference to a loaded sf::Font to use for
+    //                          glyph data
+    /// \param area             Width and height of the grid in # of tiles
+    /// \param spacing          Width and height of each tile in pixels
+    /// \param characterSize    Size of each glyph
+    /// \param layerCount       Number of layers, drawn in increasing order
+    ///////////////////////////////////////////////////////////////////////////
+    LayeredGlyphTileMap(sf::Font& font, const sf::Vector2u& area,
+        const sf::Vector2u& spacing, sf::Uint32 characterSize,
+        sf::Uint32 layerCount);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor taking glyphs from a BakedGlyphAtlas
+    ///
+    /// \param atlas        Reference to a loaded BakedGlyphAtlas, which must
+    ///                     outlive the LayeredGlyphTileMap
+    /// \param area         Width and height of the grid in # of tiles
+    /// \param spacing      Width and height of each tile in pixels
+    /// \param layerCount   Number of layers, drawn in increasing order
+    ///////////////////////////////////////////////////////////////////////////
+    LayeredGlyphTileMap(const BakedGlyphAtlas& atlas,
+        const sf::Vector2u& area, const sf::Vector2u& spacing,
+        sf::Uint32 layerCount);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a const reference to the area of the grid in tiles
+    ///
+    /// \return a const reference to the area of the grid in tiles
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Vector2u& getArea() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a const reference to the spacing of the tiles
+    ///
+    /// \return a const reference to the spacing of the tiles
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Vector2u& getSpacing() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the character size of the tiles
+    ///
+    /// \return the character size of the tiles
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint32 getCharacterSize() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of layers
+    ///
+    /// \return the number of layers
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint32 getLayerCount() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the number of quads that will be drawn
+    ///
+    /// Empty tiles and tiles hidden beneath an opaque background on a higher
+    /// layer are not counted, since they are not drawn.
+    ///
+    /// \return the number of quads in the vertex stream
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Uint32 getQuadCount() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the Tile of a layer at a coords
+    ///
+    /// \param layer    Index of the layer to read
+    /// \param coords   Coordinates in the grid to read
+    ///
+    /// \return the Tile at coords
+    ///////////////////////////////////////////////////////////////////////////
+    Tile getTile(sf::Uint32 layer, const sf::Vector2u& coords) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates a layer at a coords with data from a Tile
+    ///
+    /// \param layer    Index of the layer to update
+    /// \param coords   Coordinates in the grid to update
+    /// \param tile     GlyphTileMap::Tile to update the layer with
+    ///////////////////////////////////////////////////////////////////////////
+    void setTile(sf::Uint32 layer, const sf::Vector2u& coords,
+        const Tile& tile);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates the character of a layer at a coords
+    ///
+    /// \param layer        Index of the layer to update
+    /// \param coords       Coordinates in the grid to update
+    /// \param character    New character for the tile
+    /// \param type         Tile::Type of the new character (default Center)
+    /// \param offset       Exact spacing offset value of the new character
+    ///                     (default {0, 0})
+    ///////////////////////////////////////////////////////////////////////////
+    void setTileCharacter(sf::Uint32 layer, const sf::Vector2u& coords,
+        wchar_t character, Tile::Type type = Tile::Center,
+        const sf::Vector2i& offset = {0, 0});
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates the foreground color of a layer at a coords
+    ///
+    /// \param layer    Index of the layer to update
+    /// \param coords   Coordinates in the grid to update
+    /// \param color    New foreground color for the tile
+    ///////////////////////////////////////////////////////////////////////////
+    void setTileForeground(sf::Uint32 layer, const sf::Vector2u& coords,
+        const sf::Color& color);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates the background color of a layer at a coords
+    ///
+    /// \param layer    Index of the layer to update
+    /// \param coords   Coordinates in the grid to update
+    /// \param color    New background color for the tile
+    ///////////////////////////////////////////////////////////////////////////
+    void setTileBackground(sf::Uint32 layer, const sf::Vector2u& coords,
+        const sf::Color& color);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates a rectangle of a layer with data from a Tile
+    ///
+    /// The rectangle is clipped to the grid.
+    ///
+    /// \param layer    Index of the layer to update
+    /// \param coords   Coordinates of the top left tile of the rectangle
+    /// \param area     Width and height of the rectangle in # of tiles
+    /// \param tile     GlyphTileMap::Tile to fill the rectangle with
+    ///////////////////////////////////////////////////////////////////////////
+    void fillTiles(sf::Uint32 layer, const sf::Vector2u& coords,
+        const sf::Vector2u& area, const Tile& tile);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Frees the storage of a layer, resetting its tiles to blank
+    ///
+    /// \param layer    Index of the layer to clear
+    ///////////////////////////////////////////////////////////////////////////
+    void clearLayer(sf::Uint32 layer);
+
+private:
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Tile& getLayerTile(sf::Uint32 layer, const sf::Vector2u& coords);
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void ensureVerticesUpdate() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void updateRow(sf::Uint32 layer, bool foreground, sf::Uint32 y,
+        std::vector<sf::Vertex>& vertices) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static void appendQuad(std::vector<sf::Vertex>& vertices, float x,
+        float y, float width, float height, const sf::FloatRect& textureRect,
+        const sf::Color& color);
+
+    ///////////////////////////////////////////////////////////////////////////
+    mutable GlyphCache m_glyphCache;
+    sf::Vector2u m_area;
+    sf::Vector2u m_spacing;
+    std::vector<std::vector<Tile>> m_layers;
+    Tile m_blank;
+    mutable bool m_dirty;
+    mutable std::vector<sf::Uint8> m_dirtyRows;
+    mutable std::vector<std::vector<sf::Vertex>> m_rowVertices;
+    mutable std::vector<sf::Uint32> m_rowOffsets;
+    mutable std::vector<sf::Vertex> m_vertices;
+    mutable std::vector<sf::Uint32> m_baseLayers;
+};
+
+#endif
@@ -8,6 +8,7 @@
 #include <ctime>
 #include <cstdlib>
 #include <iostream>
+#include <vector>
 
 #include <SFML/System.hpp>
 #include <SFML/Window.hpp>
@@ -36,18 +37,25 @@ sf::Color randColor()
         );
 }
 
-void randomizeTiles(GlyphTileMap& tileMap)
+void randomizeTiles(GlyphTileMap& tileMap,
+    const std::vector<sf::Uint32>& charset)
 {
-    for (sf::Uint32 i = 0; i < tileMap.getArea().x; ++i)
-    for (sf::Uint32 j = 0; j < tileMap.getArea().y; ++j) {
+    std::vector<GlyphTileMap::Tile> tiles;
+    tiles.reserve(tileMap.getArea().x * tileMap.getArea().y);
 
-        tileMap.setTile({i, j}, GlyphTileMap::Tile(
-                static_cast<wchar_t>(std::rand()%65536),
+    for (sf::Uint32 j = 0; j < tileMap.getArea().y; ++j)
+    for (sf::Uint32 i = 0; i < tileMap.getArea().x; ++i) {
+
+        tiles.emplace_back(
+                static_cast<wchar_t>(charset[std::rand() % charset.size()]),
                 GlyphTileMap::Tile::Center,
                 randColor(),
                 randColor()
-                ));
+                );
     }
+
+    tileMap.setTiles({0, 0}, tileMap.getArea(), tiles.data());
+    tileMap.rebuild();
 }
 
 int main()
@@ -82,7 +90,18 @@ int main()
     }
 
     GlyphTileMap tileMap(unifont, {40, 30}, {16, 16}, 16);
-    randomizeTiles(tileMap);
+    tileMap.setDeferred(true);
+
+    // randomizeTiles draws from code page 437, so rasterize just that up
+    // front instead of growing the atlas mid-frame.
+    const std::vector<sf::Uint32> charset =
+        GlyphTileMap::getCharset(GlyphTileMap::CP437);
+    GlyphTileMap::PrewarmReport prewarm = tileMap.prewarmGlyphs(charset);
+    std::cout << "Prewarmed " << prewarm.glyphCount << " glyphs in "
+        << prewarm.rasterizationTime.asMilliseconds() << " ms ("
+        << prewarm.atlasGrowths << " atlas growths)" << std::endl;
+
+    randomizeTiles(tileMap, charset);
 
     sf::Clock timer;
     sf::Uint32 deltaTime = 0;
@@ -110,15 +129,12 @@ int main()
         }
 
         if (sf::Keyboard::isKeyPressed(sf::Keyboard::Space)) {
-            randomizeTiles(tileMap);
+            randomizeTiles(tileMap, charset);
         }
 
         if (sf::Keyboard::isKeyPressed(sf::Keyboard::F)) {
             //sf::Color color = randColor();
-            for (sf::Uint32 i = 0; i < tileMap.getArea().x; ++i)
-            for (sf::Uint32 j = 0; j < tileMap.getArea().y; ++j) {
-                tileMap.setTileCharacter({i, j}, L'?');
-            }
+            tileMap.fillTileCharacter({0, 0}, tileMap.getArea(), L'?');
         }
 
         frame.clear();
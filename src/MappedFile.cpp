@@ -0,0 +1,154 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       MappedFile.cpp
+/// License:        MIT
+/// Description:    A read-only memory mapping of a whole file.
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+MappedFile::MappedFile()
+    : m_data(nullptr)
+    , m_size(0)
+#ifdef _WIN32
+    , m_file(INVALID_HANDLE_VALUE)
+    , m_mapping(nullptr)
+#endif
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+///////////////////////////////////////////////////////////////////////////////
+bool MappedFile::open(const std::string& filename)
+{
+    close();
+
+    m_file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+        close();
+        return false;
+    }
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0,
+        nullptr);
+    if (!m_mapping) {
+        close();
+        return false;
+    }
+
+    m_data = static_cast<const sf::Uint8*>(MapViewOfFile(m_mapping,
+        FILE_MAP_READ, 0, 0, 0));
+    if (!m_data) {
+        close();
+        return false;
+    }
+
+    m_size = static_cast<std::size_t>(size.QuadPart);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MappedFile::close()
+{
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+    }
+
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+    }
+
+    if (m_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+    m_file = INVALID_HANDLE_VALUE;
+    m_mapping = nullptr;
+}
+
+#else
+
+///////////////////////////////////////////////////////////////////////////////
+bool MappedFile::open(const std::string& filename)
+{
+    close();
+
+    int file = ::open(filename.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+
+    // The mapping stays valid after the descriptor is closed.
+    struct stat status;
+    void* data = MAP_FAILED;
+
+    if (fstat(file, &status) == 0 && status.st_size > 0) {
+        data = mmap(nullptr, static_cast<std::size_t>(status.st_size),
+            PROT_READ, MAP_PRIVATE, file, 0);
+    }
+
+    ::close(file);
+
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    m_data = static_cast<const sf::Uint8*>(data);
+    m_size = static_cast<std::size_t>(status.st_size);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MappedFile::close()
+{
+    if (m_data) {
+        munmap(const_cast<sf::Uint8*>(m_data), m_size);
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Uint8* MappedFile::getData() const
+{
+    return m_data;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+std::size_t MappedFile::getSize() const
+{
+    return m_size;
+}
@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       MappedFile.h
+/// License:        MIT
+/// Description:    A read-only memory mapping of a whole file.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef>
+#include <string>
+
+#include <SFML/System.hpp>
+
+class MappedFile : sf::NonCopyable {
+public:
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Default constructor
+    ///
+    /// Creates an empty MappedFile with no data.
+    ///////////////////////////////////////////////////////////////////////////
+    MappedFile();
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Destructor
+    ///
+    /// Unmaps the file, invalidating any pointers into its data.
+    ///////////////////////////////////////////////////////////////////////////
+    ~MappedFile();
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Maps a whole file into memory for reading
+    ///
+    /// Pages of the file are read by the OS on first access, so opening a
+    /// large file is cheap and only the parts that are used cost anything.
+    /// Any previously mapped file is unmapped first.
+    ///
+    /// \param filename Path of the file to map
+    ///
+    /// \return true if the file was mapped; empty files cannot be mapped
+    ///////////////////////////////////////////////////////////////////////////
+    bool open(const std::string& filename);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Unmaps the file, if any
+    ///////////////////////////////////////////////////////////////////////////
+    void close();
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns a pointer to the mapped data
+    ///
+    /// \return a pointer to the first byte of the file, or nullptr
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Uint8* getData() const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the size of the mapped data in bytes
+    ///
+    /// \return the size of the file, or 0 if none is mapped
+    ///////////////////////////////////////////////////////////////////////////
+    std::size_t getSize() const;
+
+private:
+
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Uint8* m_data;
+    std::size_t m_size;
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#endif
+};
+
+#endif
@@ -0,0 +1,164 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       PixelKernels.cpp
+/// License:        MIT
+/// Description:    Kernels that fill, blend and tint RGBA pixels on the CPU
+///                 the way SFML does, used by GlyphTileMap's software
+///                 renderer and lighting.
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PixelKernels.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) \
+    && _M_IX86_FP >= 2)
+#define PIXEL_KERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// Divides a product of two 8-bit values by 255, rounding to nearest.
+///////////////////////////////////////////////////////////////////////////////
+inline sf::Uint32 divide255(sf::Uint32 value)
+{
+    value += 128;
+
+    return (value + (value >> 8)) >> 8;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+inline void blendPixel(sf::Uint8* pixel, sf::Uint32 r, sf::Uint32 g,
+    sf::Uint32 b, sf::Uint32 a)
+{
+    sf::Uint32 inverse = 255 - a;
+
+    pixel[0] = static_cast<sf::Uint8>(divide255(r * a + pixel[0] * inverse));
+    pixel[1] = static_cast<sf::Uint8>(divide255(g * a + pixel[1] * inverse));
+    pixel[2] = static_cast<sf::Uint8>(divide255(b * a + pixel[2] * inverse));
+    pixel[3] = static_cast<sf::Uint8>(a + divide255(pixel[3] * inverse));
+}
+
+#ifdef PIXEL_KERNELS_SSE2
+///////////////////////////////////////////////////////////////////////////////
+/// Multiplies eight pairs of bytes widened to 16 bits and divides the
+/// products by 255, rounding exactly as divide255 does.
+///////////////////////////////////////////////////////////////////////////////
+inline __m128i modulate16(__m128i a, __m128i b)
+{
+    __m128i value = _mm_add_epi16(_mm_mullo_epi16(a, b),
+        _mm_set1_epi16(128));
+
+    return _mm_srli_epi16(_mm_add_epi16(value, _mm_srli_epi16(value, 8)), 8);
+}
+#endif
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Color blendColor(const sf::Color& destination, const sf::Color& source)
+{
+    sf::Uint8 pixel[4] = {destination.r, destination.g, destination.b,
+        destination.a};
+
+    blendPixel(pixel, source.r, source.g, source.b, source.a);
+
+    return sf::Color(pixel[0], pixel[1], pixel[2], pixel[3]);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Color modulateColor(const sf::Color& color, const sf::Color& tint)
+{
+    return sf::Color(
+        static_cast<sf::Uint8>(divide255(color.r * tint.r)),
+        static_cast<sf::Uint8>(divide255(color.g * tint.g)),
+        static_cast<sf::Uint8>(divide255(color.b * tint.b)),
+        static_cast<sf::Uint8>(divide255(color.a * tint.a)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void modulateColors(sf::Color* destination, const sf::Color* colors,
+    const sf::Color* tints, std::size_t count)
+{
+    sf::Uint8* out = reinterpret_cast<sf::Uint8*>(destination);
+    const sf::Uint8* in = reinterpret_cast<const sf::Uint8*>(colors);
+    const sf::Uint8* by = reinterpret_cast<const sf::Uint8*>(tints);
+    std::size_t i = 0;
+
+#ifdef PIXEL_KERNELS_SSE2
+    // Four colors at a time, widened to 16 bits for the products.
+    __m128i zero = _mm_setzero_si128();
+
+    for (; i + 16 <= count * 4; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(by + i));
+        __m128i low = modulate16(_mm_unpacklo_epi8(a, zero),
+            _mm_unpacklo_epi8(b, zero));
+        __m128i high = modulate16(_mm_unpackhi_epi8(a, zero),
+            _mm_unpackhi_epi8(b, zero));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+            _mm_packus_epi16(low, high));
+    }
+#endif
+
+    for (; i < count * 4; ++i) {
+        out[i] = static_cast<sf::Uint8>(divide255(in[i] * by[i]));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void fillPixels(sf::Uint8* pixels, std::size_t count, const sf::Color& color)
+{
+    sf::Uint8 pixel[4] = {color.r, color.g, color.b, color.a};
+
+    for (std::size_t i = 0; i < count; ++i, pixels += 4) {
+        std::memcpy(pixels, pixel, 4);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void blendTexels(sf::Uint8* pixels, std::size_t pitch,
+    const sf::Uint8* texels, std::size_t texelPitch, std::size_t width,
+    std::size_t height, const sf::Color& color)
+{
+    for (std::size_t y = 0; y < height; ++y) {
+        sf::Uint8* pixel = pixels + y * pitch;
+        const sf::Uint8* texel = texels + y * texelPitch;
+
+        for (std::size_t x = 0; x < width; ++x, pixel += 4, texel += 4) {
+            // Glyph atlases are mostly empty space around each glyph, and
+            // glyphs are white with their coverage in alpha.
+            if (texel[3] == 0) {
+                continue;
+            }
+
+            sf::Uint32 a = divide255(texel[3] * color.a);
+            sf::Uint32 r = color.r;
+            sf::Uint32 g = color.g;
+            sf::Uint32 b = color.b;
+
+            if ((texel[0] & texel[1] & texel[2]) != 255) {
+                r = divide255(texel[0] * r);
+                g = divide255(texel[1] * g);
+                b = divide255(texel[2] * b);
+            }
+
+            if (a == 255) {
+                pixel[0] = static_cast<sf::Uint8>(r);
+                pixel[1] = static_cast<sf::Uint8>(g);
+                pixel[2] = static_cast<sf::Uint8>(b);
+                pixel[3] = 255;
+            } else if (a > 0) {
+                blendPixel(pixel, r, g, b, a);
+            }
+        }
+    }
+}
@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       QuadKernels.cpp
+/// License:        MIT
+/// Description:    Kernels that generate runs of textured, colored quads from
+///                 structure-of-arrays input, used by GlyphTileMap for bulk
+///                 vertex generation.
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include "QuadKernels.h"
+
+#include <cstddef>
+
+#ifdef QUAD_KERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+/// The SSE2 kernel stores whole vertices as floats, so sf::Vertex must be
+/// position, color, texCoords with no padding.
+///////////////////////////////////////////////////////////////////////////////
+static_assert(sizeof(sf::Vertex) == 20, "sf::Vertex must be 20 bytes");
+static_assert(offsetof(sf::Vertex, color) == 8, "unexpected sf::Vertex");
+static_assert(offsetof(sf::Vertex, texCoords) == 12, "unexpected sf::Vertex");
+
+///////////////////////////////////////////////////////////////////////////////
+void writeQuads(sf::Vertex* quads, const QuadRun& run, std::size_t count)
+{
+#ifdef QUAD_KERNELS_SSE2
+    writeQuadsSSE2(quads, run, count);
+#else
+    writeQuadsScalar(quads, run, count);
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void writeQuadsScalar(sf::Vertex* quads, const QuadRun& run,
+    std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i, quads += 4) {
+        float x = run.x[i];
+        float y = run.y[i];
+        float left = run.left[i];
+        float top = run.top[i];
+        float width = run.width[i];
+        float height = run.height[i];
+
+        quads[0].position = {x, y};
+        quads[1].position = {x + width, y};
+        quads[2].position = {x + width, y + height};
+        quads[3].position = {x, y + height};
+        quads[0].texCoords = {left, top};
+        quads[1].texCoords = {left + width, top};
+        quads[2].texCoords = {left + width, top + height};
+        quads[3].texCoords = {left, top + height};
+        quads[0].color = run.color[i];
+        quads[1].color = run.color[i];
+        quads[2].color = run.color[i];
+        quads[3].color = run.color[i];
+    }
+}
+
+#ifdef QUAD_KERNELS_SSE2
+
+namespace
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// Transposes four attribute vectors and stores lane i of each, in order, as
+/// the four floats at out + i * 20, i.e. the same row of consecutive quads.
+///////////////////////////////////////////////////////////////////////////////
+inline void storeTransposed(float* out, __m128 a, __m128 b, __m128 c,
+    __m128 d)
+{
+    _MM_TRANSPOSE4_PS(a, b, c, d);
+    _mm_storeu_ps(out, a);
+    _mm_storeu_ps(out + 20, b);
+    _mm_storeu_ps(out + 40, c);
+    _mm_storeu_ps(out + 60, d);
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void writeQuadsSSE2(sf::Vertex* quads, const QuadRun& run, std::size_t count)
+{
+    std::size_t i = 0;
+
+    // A quad is 20 floats (the color travels as raw bits). Laid out as five
+    // rows of four, each row is a 4x4 transpose of per-attribute vectors, so
+    // four quads take 20 shuffled stores and no scalar work.
+    for (; i + 4 <= count; i += 4, quads += 16) {
+        __m128 x0 = _mm_loadu_ps(run.x + i);
+        __m128 y0 = _mm_loadu_ps(run.y + i);
+        __m128 u0 = _mm_loadu_ps(run.left + i);
+        __m128 v0 = _mm_loadu_ps(run.top + i);
+        __m128 width = _mm_loadu_ps(run.width + i);
+        __m128 height = _mm_loadu_ps(run.height + i);
+        __m128 c = _mm_castsi128_ps(_mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(run.color + i)));
+        __m128 x1 = _mm_add_ps(x0, width);
+        __m128 y1 = _mm_add_ps(y0, height);
+        __m128 u1 = _mm_add_ps(u0, width);
+        __m128 v1 = _mm_add_ps(v0, height);
+
+        float* out = reinterpret_cast<float*>(quads);
+
+        storeTransposed(out, x0, y0, c, u0);
+        storeTransposed(out + 4, v0, x1, y0, c);
+        storeTransposed(out + 8, u1, v0, x1, y1);
+        storeTransposed(out + 12, c, u1, v1, x0);
+        storeTransposed(out + 16, y1, c, u0, v1);
+    }
+
+    QuadRun tail = {run.x + i, run.y + i, run.left + i, run.top + i,
+        run.width + i, run.height + i, run.color + i};
+    writeQuadsScalar(quads, tail, count - i);
+}
+
+#endif
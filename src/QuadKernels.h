@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       QuadKernels.h
+/// License:        MIT
+/// Description:    Kernels that generate runs of textured, colored quads from
+///                 structure-of-arrays input, used by GlyphTileMap for bulk
+///                 vertex generation.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef QUAD_KERNELS_H
+#define QUAD_KERNELS_H
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef>
+
+#include <SFML/System.hpp>
+#include <SFML/Graphics.hpp>
+
+///////////////////////////////////////////////////////////////////////////////
+/// QuadRun describes a run of quads as parallel arrays, one element per quad:
+///
+/// x, y            Position of the quad's top left corner
+/// left, top       Texture coordinates of the quad's top left corner
+/// width, height   Size of the quad, both on screen and in the texture
+/// color           Color of the quad's four vertices
+///////////////////////////////////////////////////////////////////////////////
+struct QuadRun {
+    const float* x;
+    const float* y;
+    const float* left;
+    const float* top;
+    const float* width;
+    const float* height;
+    const sf::Color* color;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Writes a run of quads using the fastest kernel available
+///
+/// Selected at compile time: SSE2 on x86 and x86-64, scalar elsewhere. Every
+/// kernel produces bit-identical vertices.
+///
+/// \param quads    Destination of count * 4 vertices
+/// \param run      Per-quad input arrays
+/// \param count    Number of quads to write
+///////////////////////////////////////////////////////////////////////////////
+void writeQuads(sf::Vertex* quads, const QuadRun& run, std::size_t count);
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Writes a run of quads one vertex at a time
+///
+/// \param quads    Destination of count * 4 vertices
+/// \param run      Per-quad input arrays
+/// \param count    Number of quads to write
+///////////////////////////////////////////////////////////////////////////////
+void writeQuadsScalar(sf::Vertex* quads, const QuadRun& run,
+    std::size_t count);
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) \
+    && _M_IX86_FP >= 2)
+#define QUAD_KERNELS_SSE2
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Writes a run of quads four at a time with SSE2
+///
+/// \param quads    Destination of count * 4 vertices
+/// \param run      Per-quad input arrays
+/// \param count    Number of quads to write
+///////////////////////////////////////////////////////////////////////////////
+void writeQuadsSSE2(sf::Vertex* quads, const QuadRun& run, std::size_t count);
+
+#endif
+
+#endif
@@ -0,0 +1,626 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       StaticGlyphTileMap.h
+/// License:        MIT
+/// Description:    A GlyphTileMap whose dimensions, spacing and glyph
+///                 alignment are fixed at compile time, with its tiles and
+///                 vertices stored inline.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef STATIC_GLYPH_TILE_MAP_H
+#define STATIC_GLYPH_TILE_MAP_H
+
+///////////////////////////////////////////////////////////////////////////////
+/// Headers
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <array>
+
+#include <SFML/System.hpp>
+#include <SFML/Graphics.hpp>
+
+#include "GlyphCache.h"
+#include "GlyphTileMap.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// Alignment policies place a glyph within its tile the way the Tile::Type
+/// of the same name does. Only ExactAlign uses the Tile's offset.
+///
+/// The offsets are worked out from the glyph's metrics and the spacing given
+/// as template arguments, instead of taken from the GlyphCache, so the
+/// spacing terms are constants the compiler folds in.
+///////////////////////////////////////////////////////////////////////////////
+struct TextAlign {
+    template <unsigned SpacingX, unsigned SpacingY>
+    static sf::Vector2i getOffset(const GlyphCache::Glyph& glyph,
+        const sf::Vector2i&)
+    {
+        return {static_cast<int>(glyph.bounds.left),
+            static_cast<int>(SpacingY + glyph.bounds.top)};
+    }
+};
+
+struct CenterAlign {
+    template <unsigned SpacingX, unsigned SpacingY>
+    static sf::Vector2i getOffset(const GlyphCache::Glyph& glyph,
+        const sf::Vector2i&)
+    {
+        return {(static_cast<int>(SpacingX) - glyph.textureRect.width) / 2,
+            (static_cast<int>(SpacingY) - glyph.textureRect.height) / 2};
+    }
+};
+
+struct ExactAlign {
+    template <unsigned SpacingX, unsigned SpacingY>
+    static sf::Vector2i getOffset(const GlyphCache::Glyph& glyph,
+        const sf::Vector2i& offset)
+    {
+        return CenterAlign::getOffset<SpacingX, SpacingY>(glyph, offset)
+            + offset;
+    }
+};
+
+struct FloorAlign {
+    template <unsigned SpacingX, unsigned SpacingY>
+    static sf::Vector2i getOffset(const GlyphCache::Glyph& glyph,
+        const sf::Vector2i&)
+    {
+        return {(static_cast<int>(SpacingX) - glyph.textureRect.width) / 2,
+            static_cast<int>(SpacingY) - glyph.textureRect.height};
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// StaticGlyphTileMap is a fixed-size GlyphTileMap for grids whose size,
+/// spacing and alignment are known when compiling, such as a status bar or
+/// an 80x25 console. With every dimension a constant and no per-tile
+/// Tile::Type to branch on, the compiler can fold the position math and
+/// unroll the update loops. All of the tiles and vertices live inside the
+/// object, so large maps should be allocated statically or on the heap.
+///
+/// Backgrounds and glyphs share one vertex array and are drawn with a single
+/// draw call, backgrounds using the white texels at the top left of the
+/// glyph atlas. As in GlyphTileMap, only tiles with a visible glyph or
+/// background own a quad, so blank and transparent tiles are not drawn. Use
+/// GlyphTileMap when the size is only known at run time.
+///
+/// \tparam Width       Width of the grid in # of tiles
+/// \tparam Height      Height of the grid in # of tiles
+/// \tparam SpacingX    Width of each tile in pixels
+/// \tparam SpacingY    Height of each tile in pixels
+/// \tparam Align       TextAlign, ExactAlign, FloorAlign or CenterAlign
+///                     (default CenterAlign)
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align = CenterAlign>
+class StaticGlyphTileMap : public sf::Drawable, public sf::Transformable {
+public:
+
+    static_assert(Width > 0 && Height > 0, "the grid must not be empty");
+    static_assert(SpacingX > 0 && SpacingY > 0, "tiles must not be empty");
+
+    typedef GlyphTileMap::Tile Tile;
+
+    static const unsigned TileCount = Width * Height;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor
+    ///
+    /// All tiles start blank (L' ', White foreground, Transparent
+    /// background).
+    ///
+    /// \param font             Reference to a loaded sf::Font to use for
+    //                          glyph data
+    /// \param characterSize    Size of each glyph
+    ///////////////////////////////////////////////////////////////////////////
+    StaticGlyphTileMap(sf::Font& font, sf::Uint32 characterSize);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Constructor taking glyphs from a BakedGlyphAtlas
+    ///
+    /// \param atlas    Reference to a loaded BakedGlyphAtlas, which must
+    ///                 outlive the StaticGlyphTileMap
+    ///////////////////////////////////////////////////////////////////////////
+    explicit StaticGlyphTileMap(const BakedGlyphAtlas& atlas);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the area of the grid in tiles
+    ///
+    /// \return the area of the grid in tiles
+    ///////////////////////////////////////////////////////////////////////////
+    static sf::Vector2u getArea();
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the spacing of the tiles
+    ///
+    /// \return the spacing of the tiles
+    ///////////////////////////////////////////////////////////////////////////
+    static sf::Vector2u getSpacing();
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Returns the Tile at a coords
+    ///
+    /// \param coords   Coordinates in the grid to read
+    ///
+    /// \return a const reference to the Tile at coords
+    ///////////////////////////////////////////////////////////////////////////
+    const Tile& getTile(const sf::Vector2u& coords) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates a tile at a coords with data from a Tile
+    ///
+    /// The Tile's type is ignored in favor of Align.
+    ///
+    /// \param coords   Coordinates in the grid to update
+    /// \param tile     GlyphTileMap::Tile to update the tile with
+    ///////////////////////////////////////////////////////////////////////////
+    void setTile(const sf::Vector2u& coords, const Tile& tile);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates the character of a tile at a coords
+    ///
+    /// \param coords       Coordinates in the grid to update
+    /// \param character    New character for the tile
+    /// \param offset       Offset of the new character, used by ExactAlign
+    ///                     (default {0, 0})
+    ///////////////////////////////////////////////////////////////////////////
+    void setTileCharacter(const sf::Vector2u& coords, wchar_t character,
+        const sf::Vector2i& offset = {0, 0});
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates the foreground color of a tile at a coords
+    ///
+    /// \param coords   Coordinates in the grid to update
+    /// \param color    New foreground color for the tile
+    ///////////////////////////////////////////////////////////////////////////
+    void setTileForeground(const sf::Vector2u& coords, const sf::Color& color);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates the background color of a tile at a coords
+    ///
+    /// \param coords   Coordinates in the grid to update
+    /// \param color    New background color for the tile
+    ///////////////////////////////////////////////////////////////////////////
+    void setTileBackground(const sf::Vector2u& coords, const sf::Color& color);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates every tile with data from a Tile
+    ///
+    /// \param tile     GlyphTileMap::Tile to fill the grid with
+    ///////////////////////////////////////////////////////////////////////////
+    void fillTiles(const Tile& tile);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Updates every tile with data from an array of Tiles
+    ///
+    /// \param tiles    Width * Height Tiles, in rows
+    ///////////////////////////////////////////////////////////////////////////
+    void setTiles(const Tile* tiles);
+
+private:
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// Background quads are packed downwards from ForegroundStart in
+    /// m_vertices and foreground quads upwards from it, so all of the quads
+    /// in use are one contiguous range with every background first.
+    ///////////////////////////////////////////////////////////////////////////
+    static const unsigned ForegroundStart = TileCount * 4;
+
+    ///////////////////////////////////////////////////////////////////////////
+    static const unsigned NoQuad = 0xFFFFFFFF;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// QuadSet tracks the quads of one layer: the quad each tile owns (or
+    /// NoQuad), the tile each quad belongs to and the number in use.
+    ///////////////////////////////////////////////////////////////////////////
+    struct QuadSet {
+        std::array<unsigned, TileCount> quads;
+        std::array<unsigned, TileCount> tiles;
+        unsigned count;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr float getTileX(unsigned index)
+    {
+        return static_cast<float>((index % Width) * SpacingX);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr float getTileY(unsigned index)
+    {
+        return static_cast<float>((index / Width) * SpacingY);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void initialize();
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static unsigned getIndex(const sf::Vector2u& coords);
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void writeGlyph(unsigned index);
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void writeBackground(unsigned index);
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Vertex* getQuad(const QuadSet& set, unsigned quad);
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Vertex* acquireQuad(QuadSet& set, unsigned index);
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void releaseQuad(QuadSet& set, unsigned index);
+
+    ///////////////////////////////////////////////////////////////////////////
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static void writeColor(sf::Vertex* quad, const sf::Color& color);
+
+    ///////////////////////////////////////////////////////////////////////////
+    GlyphCache m_glyphCache;
+    std::array<Tile, TileCount> m_tiles;
+    std::array<sf::Vertex, TileCount * 8> m_vertices;
+    QuadSet m_backgrounds;
+    QuadSet m_foregrounds;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+const unsigned StaticGlyphTileMap<Width, Height, SpacingX, SpacingY,
+    Align>::TileCount;
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+const unsigned StaticGlyphTileMap<Width, Height, SpacingX, SpacingY,
+    Align>::ForegroundStart;
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+const unsigned StaticGlyphTileMap<Width, Height, SpacingX, SpacingY,
+    Align>::NoQuad;
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+StaticGlyphTileMap<Width, Height, SpacingX, SpacingY, Align>::
+    StaticGlyphTileMap(sf::Font& font, sf::Uint32 characterSize)
+    : m_glyphCache(font, characterSize, {SpacingX, SpacingY})
+    , m_tiles()
+    , m_vertices()
+    , m_backgrounds()
+    , m_foregrounds()
+{
+    initialize();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+StaticGlyphTileMap<Width, Height, SpacingX, SpacingY, Align>::
+    StaticGlyphTileMap(const BakedGlyphAtlas& atlas)
+    : m_glyphCache(atlas, {SpacingX, SpacingY})
+    , m_tiles()
+    , m_vertices()
+    , m_backgrounds()
+    , m_foregrounds()
+{
+    initialize();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+sf::Vector2u StaticGlyphTileMap<Width, Height, SpacingX, SpacingY, Align>::
+    getArea()
+{
+    return {Width, Height};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+sf::Vector2u StaticGlyphTileMap<Width, Height, SpacingX, SpacingY, Align>::
+    getSpacing()
+{
+    return {SpacingX, SpacingY};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+const typename StaticGlyphTileMap<Width, Height, SpacingX, SpacingY,
+    Align>::Tile& StaticGlyphTileMap<Width, Height, SpacingX, SpacingY,
+    Align>::getTile(const sf::Vector2u& coords) const
+{
+    return m_tiles[getIndex(coords)];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+void StaticGlyphTileMap<Width, Height, SpacingX, SpacingY, Align>::setTile(
+    const sf::Vector2u& coords, const Tile& tile)
+{
+    unsigned index = getIndex(coords);
+
+    m_tiles[index] = tile;
+    writeGlyph(index);
+    writeBackground(index);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+void StaticGlyphTileMap<Width, Height, SpacingX, SpacingY, Align>::
+    setTileCharacter(const sf::Vector2u& coords, wchar_t character,
+    const sf::Vector2i& offset)
+{
+    unsigned index = getIndex(coords);
+
+    m_tiles[index].character = character;
+    m_tiles[index].offset = offset;
+    writeGlyph(index);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+void StaticGlyphTileMap<Width, Height, SpacingX, SpacingY, Align>::
+    setTileForeground(const sf::Vector2u& coords, const sf::Color& color)
+{
+    unsigned index = getIndex(coords);
+    bool visible = m_tiles[index].foreground.a > 0;
+
+    m_tiles[index].foreground = color;
+
+    // Only a change of visibility adds or removes the glyph's quad.
+    if (visible != (color.a > 0)) {
+        writeGlyph(index);
+    } else if (m_foregrounds.quads[index] != NoQuad) {
+        writeColor(getQuad(m_foregrounds, m_foregrounds.quads[index]), color);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+void StaticGlyphTileMap<Width, Height, SpacingX, SpacingY, Align>::
+    setTileBackground(const sf::Vector2u& coords, const sf::Color& color)
+{
+    unsigned index = getIndex(coords);
+
+    m_tiles[index].background = color;
+    writeBackground(index);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+void StaticGlyphTileMap<Width, Height, SpacingX, SpacingY, Align>::fillTiles(
+    const Tile& tile)
+{
+    m_tiles.fill(tile);
+
+    for (unsigned index = 0; index < TileCount; ++index) {
+        writeGlyph(index);
+        writeBackground(index);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+void StaticGlyphTileMap<Width, Height, SpacingX, SpacingY, Align>::setTiles(
+    const Tile* tiles)
+{
+    for (unsigned index = 0; index < TileCount; ++index) {
+        m_tiles[index] = tiles[index];
+        writeGlyph(index);
+        writeBackground(index);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+void StaticGlyphTileMap<Width, Height, SpacingX, SpacingY, Align>::draw(
+    sf::RenderTarget& target, sf::RenderStates states) const
+{
+    unsigned first = ForegroundStart - (m_backgrounds.count * 4);
+    unsigned count = (m_backgrounds.count + m_foregrounds.count) * 4;
+
+    if (count == 0) {
+        return;
+    }
+
+    states.transform *= getTransform();
+    states.texture = &m_glyphCache.getTexture();
+    target.draw(&m_vertices[first], count, sf::Quads, states);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+void StaticGlyphTileMap<Width, Height, SpacingX, SpacingY, Align>::
+    initialize()
+{
+    m_backgrounds.quads.fill(NoQuad);
+    m_backgrounds.count = 0;
+    m_foregrounds.quads.fill(NoQuad);
+    m_foregrounds.count = 0;
+
+    fillTiles(Tile(L' ', Tile::Center, sf::Color::White,
+        sf::Color::Transparent));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+unsigned StaticGlyphTileMap<Width, Height, SpacingX, SpacingY, Align>::
+    getIndex(const sf::Vector2u& coords)
+{
+    return (coords.y * Width) + coords.x;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+void StaticGlyphTileMap<Width, Height, SpacingX, SpacingY, Align>::
+    writeGlyph(unsigned index)
+{
+    const Tile& tile = m_tiles[index];
+    const GlyphCache::Glyph& glyph = m_glyphCache.get(
+        static_cast<sf::Uint32>(tile.character));
+
+    // Blank glyphs and transparent foregrounds own no quad.
+    if (tile.foreground.a == 0 || glyph.textureRect.width <= 0
+        || glyph.textureRect.height <= 0) {
+        releaseQuad(m_foregrounds, index);
+        return;
+    }
+
+    sf::Vector2i offset = Align::template getOffset<SpacingX, SpacingY>(
+        glyph, tile.offset);
+    sf::Vertex* quad = acquireQuad(m_foregrounds, index);
+
+    // Offsets can be negative, so they are added after leaving unsigned.
+    float x = getTileX(index) + offset.x;
+    float y = getTileY(index) + offset.y;
+    float width = static_cast<float>(glyph.textureRect.width);
+    float height = static_cast<float>(glyph.textureRect.height);
+    float left = static_cast<float>(glyph.textureRect.left);
+    float top = static_cast<float>(glyph.textureRect.top);
+
+    quad[0].position = {x, y};
+    quad[1].position = {x + width, y};
+    quad[2].position = {x + width, y + height};
+    quad[3].position = {x, y + height};
+    quad[0].texCoords = {left, top};
+    quad[1].texCoords = {left + width, top};
+    quad[2].texCoords = {left + width, top + height};
+    quad[3].texCoords = {left, top + height};
+
+    writeColor(quad, tile.foreground);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+void StaticGlyphTileMap<Width, Height, SpacingX, SpacingY, Align>::
+    writeBackground(unsigned index)
+{
+    const sf::Color& color = m_tiles[index].background;
+
+    if (color.a == 0) {
+        releaseQuad(m_backgrounds, index);
+        return;
+    }
+
+    sf::Vertex* quad = acquireQuad(m_backgrounds, index);
+    float x = getTileX(index);
+    float y = getTileY(index);
+
+    quad[0].position = {x, y};
+    quad[1].position = {x + SpacingX, y};
+    quad[2].position = {x + SpacingX, y + SpacingY};
+    quad[3].position = {x, y + SpacingY};
+
+    for (unsigned i = 0; i < 4; ++i) {
+        quad[i].texCoords = {1.f, 1.f};
+    }
+
+    writeColor(quad, color);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+sf::Vertex* StaticGlyphTileMap<Width, Height, SpacingX, SpacingY, Align>::
+    getQuad(const QuadSet& set, unsigned quad)
+{
+    return &set == &m_foregrounds
+        ? &m_vertices[ForegroundStart + (quad * 4)]
+        : &m_vertices[ForegroundStart - ((quad + 1) * 4)];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+sf::Vertex* StaticGlyphTileMap<Width, Height, SpacingX, SpacingY, Align>::
+    acquireQuad(QuadSet& set, unsigned index)
+{
+    if (set.quads[index] == NoQuad) {
+        set.quads[index] = set.count;
+        set.tiles[set.count] = index;
+        ++set.count;
+    }
+
+    return getQuad(set, set.quads[index]);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+void StaticGlyphTileMap<Width, Height, SpacingX, SpacingY, Align>::
+    releaseQuad(QuadSet& set, unsigned index)
+{
+    unsigned quad = set.quads[index];
+
+    if (quad == NoQuad) {
+        return;
+    }
+
+    // The last quad moves into the hole, keeping the quads in use packed.
+    unsigned last = --set.count;
+
+    if (quad != last) {
+        sf::Vertex* from = getQuad(set, last);
+        std::copy(from, from + 4, getQuad(set, quad));
+        set.tiles[quad] = set.tiles[last];
+        set.quads[set.tiles[quad]] = quad;
+    }
+
+    set.quads[index] = NoQuad;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <unsigned Width, unsigned Height, unsigned SpacingX,
+    unsigned SpacingY, typename Align>
+void StaticGlyphTileMap<Width, Height, SpacingX, SpacingY, Align>::
+    writeColor(sf::Vertex* quad, const sf::Color& color)
+{
+    quad[0].color = color;
+    quad[1].color = color;
+    quad[2].color = color;
+    quad[3].color = color;
+}
+
+#endif
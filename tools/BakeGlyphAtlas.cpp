@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Author:         Jacob P Adkins (github.com/jpadkins)
+/// Filename:       BakeGlyphAtlas.cpp
+/// License:        MIT
+/// Description:    Command line tool that bakes the glyphs of a font at one
+///                 character size into a file for BakedGlyphAtlas.
+///
+/// Usage:
+///
+///     bake_glyph_atlas <font> <characterSize> <output> [charset...]
+///
+/// Each charset is ascii, cp437, box or an inclusive range of hexadecimal
+/// codepoints such as 2500-257F. The default is cp437.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <SFML/System.hpp>
+#include <SFML/Graphics.hpp>
+
+#include "BakedGlyphAtlas.h"
+#include "GlyphTileMap.h"
+
+bool appendCharset(std::vector<sf::Uint32>& codepoints,
+    const std::string& name)
+{
+    std::vector<sf::Uint32> charset;
+
+    if (name == "ascii") {
+        charset = GlyphTileMap::getCharset(GlyphTileMap::Ascii);
+    } else if (name == "cp437") {
+        charset = GlyphTileMap::getCharset(GlyphTileMap::CP437);
+    } else if (name == "box") {
+        charset = GlyphTileMap::getCharset(GlyphTileMap::BoxDrawing);
+    } else {
+        std::string::size_type dash = name.find('-');
+        if (dash == std::string::npos || dash == 0
+            || dash + 1 == name.size()) {
+            return false;
+        }
+
+        char* end = nullptr;
+        GlyphTileMap::GlyphRange range;
+        range.first = std::strtoul(name.c_str(), &end, 16);
+        if (end != name.c_str() + dash) {
+            return false;
+        }
+        range.last = std::strtoul(name.c_str() + dash + 1, &end, 16);
+        if (*end != '\0' || range.last < range.first) {
+            return false;
+        }
+
+        charset = GlyphTileMap::getCharset({range});
+    }
+
+    codepoints.insert(codepoints.end(), charset.begin(), charset.end());
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 4) {
+        std::cerr << "usage: " << argv[0]
+            << " <font> <characterSize> <output> [charset...]" << std::endl
+            << "charsets: ascii, cp437, box or a hex range like 2500-257F"
+            << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    sf::Font font;
+    if (!font.loadFromFile(argv[1])) {
+        return EXIT_FAILURE;
+    }
+
+    sf::Uint32 characterSize = std::strtoul(argv[2], nullptr, 10);
+    if (characterSize == 0) {
+        std::cerr << "invalid character size: " << argv[2] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<sf::Uint32> codepoints;
+    for (int i = 4; i < argc; ++i) {
+        if (!appendCharset(codepoints, argv[i])) {
+            std::cerr << "invalid charset: " << argv[i] << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    if (argc == 4) {
+        appendCharset(codepoints, "cp437");
+    }
+
+    sf::Clock clock;
+    if (!BakedGlyphAtlas::bake(font, characterSize, codepoints, argv[3])) {
+        return EXIT_FAILURE;
+    }
+    sf::Int32 elapsed = clock.getElapsedTime().asMilliseconds();
+
+    // bake() drops duplicate and invalid codepoints, so count what it wrote
+    // by loading the file back, which also checks that it loads.
+    BakedGlyphAtlas atlas;
+    if (!atlas.loadFromFile(argv[3])) {
+        std::cerr << "failed to load " << argv[3] << " after baking"
+            << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Baked " << atlas.getGlyphCount() << " glyphs at size "
+        << characterSize << " into " << argv[3] << " in " << elapsed << " ms"
+        << std::endl;
+
+    return EXIT_SUCCESS;
+}